@@ -0,0 +1,147 @@
+#include "bringup.h"
+#include <cstdint>
+#include <time.h>
+#include <vector>
+
+namespace BringUp
+{
+	int64_t Now(void)
+	{
+		struct timespec ts;
+		clock_gettime(CLOCK_MONOTONIC, &ts);
+		return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+	}
+
+	int Run(CMMCRTSingleAxis* axes, const OpMode::Binding* bindings, int count,
+			Result* results, const Params& params)
+	{
+		const int64_t start = Now();
+		std::vector<int64_t> since(count, start);	// start of the current step
+
+		auto fail = [&](int i, const char* error, int64_t now)
+		{
+			results[i].failed = true;
+			results[i].error = error;
+			results[i].elapsed = (now - start) * 1e-6;
+		};
+
+		// all requests out first, the drives work on them in parallel.
+		for (int i = 0; i < count; ++i)
+		{
+			results[i] = Result{STEP::OpMode, false, 0.0, nullptr, 0};
+
+			try
+			{
+				axes[i].SetBoolParameter(0, // 0 - NC profiler; 2 - User;
+										 bindings[i].source,
+										 0);
+				axes[i].SetOpMode(bindings[i].opMode);
+			}
+			catch (CMMCException& e)
+			{
+				results[i].code = e.error();
+				fail(i, "MMC exception", Now());
+			}
+		}
+
+		int pending;
+		do
+		{
+			pending = 0;
+			const int64_t now = Now();
+
+			for (int i = 0; i < count; ++i)
+			{
+				Result& result = results[i];
+				if (result.failed || (result.step == STEP::Ready))
+					continue;
+
+				const int64_t inStep = now - since[i];
+
+				try
+				{
+					switch (result.step)
+					{
+					case STEP::OpMode:
+						if (axes[i].GetOpMode() == bindings[i].opMode)
+						{
+							axes[i].SetBoolParameter(2, bindings[i].source, 0);
+							bindings[i].zero(axes[i]);
+							result.step = STEP::Settle;
+							since[i] = now;
+						}
+						else if (inStep > params.opModeTimeout * 1000000LL)
+							fail(i, "op-mode timeout", now);
+						break;
+
+					case STEP::Settle:
+						// wait some time for ensure the mode changes done.
+						if (inStep >= params.settle * 1000000LL)
+						{
+							axes[i].PowerOn();
+							result.step = STEP::PowerOn;
+							since[i] = now;
+						}
+						break;
+
+					case STEP::PowerOn:
+					{
+						unsigned int status = axes[i].ReadStatus();
+
+						if (status & NC_AXIS_ERROR_STOP_MASK)
+							fail(i, "error stop", now);
+						else if (status & NC_AXIS_STAND_STILL_MASK)
+						{
+							result.step = STEP::Ready;
+							result.elapsed = (now - start) * 1e-6;
+						}
+						else if (inStep > params.powerOnTimeout * 1000000LL)
+							fail(i, "power-on timeout", now);
+						break;
+					}
+
+					case STEP::Ready:
+						break;
+					}
+				}
+				catch (CMMCException& e)
+				{
+					result.code = e.error();
+					fail(i, "MMC exception", now);
+				}
+
+				if (!result.failed && (result.step != STEP::Ready))
+					++pending;
+			}
+
+			if (pending)
+				usleep(params.poll * 1000);
+		} while (pending);
+
+		int failed = 0;
+		for (int i = 0; i < count; ++i)
+		{
+			if (results[i].failed)
+				++failed;
+		}
+
+		return failed;
+	}
+
+	const char* GetName(STEP step)
+	{
+		switch (step)
+		{
+		case STEP::OpMode:
+			return "op-mode";
+		case STEP::Settle:
+			return "settle";
+		case STEP::PowerOn:
+			return "power-on";
+		case STEP::Ready:
+			return "ready";
+		}
+
+		return "unknown";
+	}
+}
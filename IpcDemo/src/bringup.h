@@ -0,0 +1,42 @@
+#pragma once
+
+#include "mmcpplib.h"
+#include "opmode.h"
+
+namespace BringUp
+{
+	struct Params
+	{
+		int opModeTimeout = 1000;	// ms, op-mode request -> reported by the drive
+		int powerOnTimeout = 5000;	// ms, power-on -> stand still
+		int settle = 1;				// ms, op-mode reported -> power-on
+		int poll = 1;				// ms
+	};
+
+	enum class STEP
+	{
+		OpMode, Settle, PowerOn, Ready,
+	};
+
+	struct Result
+	{
+		STEP step;			// reached, or the one that failed
+		bool failed;
+		double elapsed;		// ms, from the start to ready / failure
+		const char* error;	// nullptr unless failed
+		int code;			// MMC error of an exception, 0 otherwise
+	};
+
+	/*
+	 * Put every axis in the op-mode of its binding, command source user with
+	 * a 0 command, and power them on. The requests go out to all axes first,
+	 * then every axis moves on by itself as soon as its drive is done, so it
+	 * takes as long as the slowest axis. Blocks until all are ready or
+	 * failed, returns the number of failed axes, 'results' gets one entry
+	 * per axis. Same steps and results as AxisBringUp of the SIL program.
+	 */
+	int Run(CMMCRTSingleAxis* axes, const OpMode::Binding* bindings, int count,
+			Result* results, const Params& params = Params());
+
+	const char* GetName(STEP step);
+}
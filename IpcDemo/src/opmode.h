@@ -0,0 +1,94 @@
+#pragma once
+
+#include <type_traits>
+#include "mmcpplib.h"
+
+namespace OpMode
+{
+	constexpr OPM402 CSP = OPM402_CYCLIC_SYNC_POSITION_MODE;
+	constexpr OPM402 CSV = OPM402_CYCLIC_SYNC_VELOCITY_MODE;
+	constexpr OPM402 CST = OPM402_CYCLIC_SYNC_TORQUE_MODE;
+
+	/*
+	 * User command of each cyclic op-mode: the parameter selecting its
+	 * source, the setter and the type it takes. Only the modes below are
+	 * defined, any other one does not compile.
+	 */
+	template<OPM402 Mode>
+	struct Traits
+	{
+		static_assert(Mode == CSP || Mode == CSV || Mode == CST,
+				"only the cyclic sync op-modes (CSP / CSV / CST) take a user command!");
+	};
+
+	template<>
+	struct Traits<CSP>
+	{
+		using Value = int;		// counts
+		static constexpr MMC_PARAMETER_LIST_ENUM source = MMC_UCUSER607A_SRC;
+
+		static void Set(CMMCRTSingleAxis& axis, Value position)
+		{
+			axis.SetUser607A(position);
+		}
+	};
+
+	template<>
+	struct Traits<CSV>
+	{
+		using Value = int;		// counts/s
+		static constexpr MMC_PARAMETER_LIST_ENUM source = MMC_UCUSER60FF_SRC;
+
+		static void Set(CMMCRTSingleAxis& axis, Value velocity)
+		{
+			axis.SetUser60FF(velocity);
+		}
+	};
+
+	template<>
+	struct Traits<CST>
+	{
+		using Value = double;	// torque
+		static constexpr MMC_PARAMETER_LIST_ENUM source = MMC_UCUSER6071_SRC;
+
+		static void Set(CMMCRTSingleAxis& axis, Value torque)
+		{
+			axis.SetUser6071(torque);
+		}
+	};
+
+	/*
+	 * Cyclic command of an axis in 'Mode', inlined. The value must have the
+	 * type of the mode, no silent conversion between position and torque.
+	 */
+	template<OPM402 Mode, typename T>
+	inline void Command(CMMCRTSingleAxis& axis, T value)
+	{
+		static_assert(std::is_same<T, typename Traits<Mode>::Value>::value,
+				"command value type does not match the op-mode!");
+
+		Traits<Mode>::Set(axis, value);
+	}
+
+	template<OPM402 Mode>
+	void Zero(CMMCRTSingleAxis& axis)
+	{
+		Traits<Mode>::Set(axis, typename Traits<Mode>::Value());
+	}
+
+	/*
+	 * Run-time view of the traits of one axis, for the non-RT set-up code.
+	 */
+	struct Binding
+	{
+		OPM402 opMode;
+		MMC_PARAMETER_LIST_ENUM source;
+		void (*zero)(CMMCRTSingleAxis&);	// 0 command
+	};
+
+	template<OPM402 Mode>
+	constexpr Binding Bind(void)
+	{
+		return Binding{Mode, Traits<Mode>::source, &Zero<Mode>};
+	}
+}
@@ -1,17 +1,32 @@
 #include "sil.h"
 #include "mmcpplib.h"
 #include "maestro.h"
+#include "bringup.h"
+#include "opmode.h"
+#include <array>
+#include <iostream>
+#include <utility>
 
 namespace Sil
 {
 	CMMCRTSingleAxis rtAxis[MAX_AXES];
 
+	// op-mode of each axis, mixed modes allowed, e.g. { OpMode::CSP, OpMode::CST }.
+	constexpr OPM402 axisMode[MAX_AXES] = { OpMode::CSP };
+
+	template<std::size_t... Axis>
+	constexpr std::array<OpMode::Binding, MAX_AXES> MakeBindings(std::index_sequence<Axis...>)
+	{
+		return {{OpMode::Bind<axisMode[Axis]>()...}};
+	}
+
+	constexpr std::array<OpMode::Binding, MAX_AXES> bindings =
+			MakeBindings(std::make_index_sequence<MAX_AXES>());
+
+	template<int Axis>
 	void DoSinGenForPosLoop(void);
 
-	OPM402 opMode = OPM402_CYCLIC_SYNC_POSITION_MODE;
-	MMC_PARAMETER_LIST_ENUM source = MMC_UCUSER607A_SRC;
-	auto currentSilFunc = DoSinGenForPosLoop;
-	void (CMMCRTSingleAxis::*command)(int) = &CMMCRTSingleAxis::SetUser607A;
+	auto currentSilFunc = DoSinGenForPosLoop<0>;
 
 	int AxisInit(void)
 	{
@@ -41,26 +56,28 @@ namespace Sil
 
 			if (rtAxis[i].ReadStatus() & NC_AXIS_ERROR_STOP_MASK)
 				rtAxis[i].Reset();
+		}
 
-			MMC_DestroySYNCTimer(Maestro::connectHandler);
-
-			rtAxis[i].SetBoolParameter(0, // 0 - NC profiler; 2 - User;
-									   source,
-									   0);
-			rtAxis[i].SetOpMode(opMode);
-			while (rtAxis[i].GetOpMode() != opMode);
-			rtAxis[i].SetBoolParameter(2, source, 0);
-
-			(rtAxis[i].*command)(0.0f);
-
-			usleep(1000);	// wait some time for ensure the mode changes done.
+		MMC_DestroySYNCTimer(Maestro::connectHandler);
 
-			rtAxis[i].PowerOn();
+		// all axes at once, start-up takes as long as the slowest one.
+		BringUp::Result results[MAX_AXES];
+		int failed = BringUp::Run(rtAxis, bindings.data(), MAX_AXES, results);
 
-			while (!(rtAxis[i].ReadStatus() & NC_AXIS_STAND_STILL_MASK))
-				usleep(10000);
+		for (int i = 0; i < MAX_AXES; ++i)
+		{
+			if (results[i].failed)
+				std::cout << "axis " << i + 1 << ": " << results[i].error << " in step "
+						  << BringUp::GetName(results[i].step) << " after "
+						  << results[i].elapsed << " ms, error " << results[i].code << "\n";
+			else
+				std::cout << "axis " << i + 1 << ": ready after " << results[i].elapsed
+						  << " ms\n";
 		}
 
+		if (failed)
+			return -1;
+
 		return 0;
 	}
 
@@ -76,10 +93,13 @@ namespace Sil
 		return;
 	}
 
+	template<int Axis>
 	void DoSinGenForPosLoop(void)
 	{
+		static_assert(axisMode[Axis] == OpMode::CSP, "DoSinGenForPosLoop() needs an axis in CSP!");
+
 		double rtb_SineWave;
-		double SineWave_AccFreqNorm = 0.0;
+		static double SineWave_AccFreqNorm = 0.0;	// accumulated phase, kept between cycles
 		double SineWave_Frequency = 1.0;
 		int rtb_DataTypeConversion;
 
@@ -105,7 +125,7 @@ namespace Sil
 						-static_cast<int>(static_cast<unsigned int>(-rtb_SineWave)) :
 						static_cast<int>(static_cast<unsigned int>(rtb_SineWave));
 
-		rtAxis[0].SetUser607A(rtb_DataTypeConversion);
+		OpMode::Command<axisMode[Axis]>(rtAxis[Axis], rtb_DataTypeConversion);
 	}
 }
 
@@ -7,7 +7,36 @@
  * 	HoldingRegister[0] -> =1: terminate the program.
  * 	HoldingRegister[1] -> set target velocity, unit: RPM.
  * 	HoldingRegister[2] -> velocity loop KP.
- * 	HoldingRegister[3] -> velocity loop KI.
+ * 	HoldingRegister[3] -> velocity loop KI, see KI_REGISTER_SCALE.
+ * 	HoldingRegister[4] -> 0 -> 1: start a frequency response measurement, Bode data written to bode.txt.
+ * 	HoldingRegister[5] -> haptic effects chained by DoEffectPipeline, bit mask:
+ * 						  bit0 smooth, bit1 damp, bit2 ratchet, bit3 walls, bit4 detent map,
+ * 						  bit5 virtual fixtures, 0 -> smooth only.
+ * 	HoldingRegister[6] -> SIL function to run, 1-based index of silFuncTable, 0 -> no change.
+ * 						  switched on the fly, including the op-mode change.
+ * 	HoldingRegister[7] -> 0 -> 1: arm the scope capture, 0 disarms, capture written to scope.txt.
+ * 	HoldingRegister[8] -> scope trigger, low byte CHANNEL (position, velocity, torque, inputs),
+ * 						  high byte TRIGGER (level, rising, falling, mask).
+ * 	HoldingRegister[9] -> scope trigger level (torque: 1/1000) or bit pattern.
+ * 	HoldingRegister[10] -> scope trigger bit mask.
+ * 	HoldingRegister[11..15] -> torque / velocity filters, see ConfigureFilters().
+ * 	HoldingRegister[16] -> 0 -> 1: stream trajectory.txt in CSP, 0 cancels.
+ * 	HoldingRegister[17] -> autotune rule, see TUNING.
+ * 	HoldingRegister[18] -> feedforward bit mask: bit0 friction, bit1 gravity / cogging.
+ * 	HoldingRegister[19] -> velocity loop gain schedule: 0 off, 1 speed, 2 position, 3 load.
+ *
+ * 	HoldingRegister[20] <- generation of the velocity loop parameters applied by the RT loop.
+ * 	HoldingRegister[21] <- SIL function running, 1-based index of silFuncTable, 0 -> switching.
+ * 	HoldingRegister[22] <- SYNC callback overruns, low 16 bits.
+ * 	HoldingRegister[23] <- 1: watchdog escalated, fallback function running until a new SIL function is selected.
+ * 	HoldingRegister[24] <- scope state: 0 idle, 1 armed, 2 triggered, 3 done.
+ * 	HoldingRegister[25] <- stream state: 0 idle, 1 streaming, 2 decelerating (underrun), 3 stopped.
+ * 	HoldingRegister[26] <- stream queue depth, setpoints.
+ * 	HoldingRegister[27] <- stream underruns, low 16 bits.
+ * 	HoldingRegister[28] <- bit i: axis i in error stop.
+ * 	HoldingRegister[29] <- longest SYNC cycle seen by the executive, us.
+ * 	HoldingRegister[30] <- autotune state: 0 idle, 1 running, 2 done, 3 failed.
+ * 	HoldingRegister[31] <- friction identification state: 0 idle, 1 running, 2 done.
  */
 #include "mmc_definitions.h"
 #include "mmcpplib.h"
@@ -15,18 +44,36 @@
 #include <sys/time.h>			// for time structure
 #include <signal.h>				// for Timer mechanism
 #include "pid.h"
+#include "param_block.h"
+#include "pid_bank.h"
+#include "gain_schedule.h"
+#include "signal_gen.h"
+#include "freq_response.h"
+#include "haptic_effects.h"
+#include "mode_manager.h"
+#include "axis_bringup.h"
+#include "rt_watchdog.h"
+#include "rt_process.h"
+#include "rt_guard.h"
+#include "state_observer.h"
+#include "torque_map.h"
+#include "scope_capture.h"
+#include "biquad_filter.h"
+#include "analog_input.h"
+#include "setpoint_stream.h"
+#include "cyclic_executive.h"
+#include "offload.h"
+#include "relay_autotune.h"
+#include "feedforward.h"
+#include <limits>
+#include <algorithm>
+#include <cmath>
 #include <chrono>
 #include <syslog.h>				// for system log
 #include <SIL_Sample.h>			// Application header file.
 #include <fstream>				// for read / write file
-
-/**
- * Motion mode list
- */
-enum class MOTIONMODE
-{
-	PMode, VMode, TMode,
-};
+#include <thread>
+#include <cstring>
 
 void DoSilTest(void);
 void DoAnalogCmdForVelLoop(void);
@@ -36,15 +83,296 @@ void DoRatchetEffect(void);
 void DoEdgeEffect(void);
 void DoSmoothEffect(void);
 void DoDampEffect(void);
+void DoFreqResponse(void);
+void DoEffectPipeline(void);
+void DoStreamForPosLoop(void);
+void DoVelLoopAutotune(void);
+void DoFrictionIdent(void);
+void DoHoldCommand(void);
+void DoStopVelocity(void);
+void DoDampAllAxes(void);
+void UpdateObservers(void);
+void UpdateAnalogInput(void);
+void RecordScope(void);
+void RunSilFunction(void);
+void MonitorAxes(void);
+void DispatchOffloadResults(void);
+void FrictionFitWork(const OffloadJob& job, OffloadResult& result);
+void FrictionFitDone(const OffloadResult& result);
+AxisState GetAxisState(int axis);
+short GainRegister(double gain, double scale);
+int BenchJitter(void);
+int BenchOffload(void);
+
+/**
+ * SIL functions selectable at run time and their motion mode,
+ * set the function want to be run at start-up by 'defaultSilFunc'.
+ */
+const ModeManager::Entry silFuncTable[] =
+{
+{ "SIL test", DoSilTest, MOTIONMODE::PMode },
+{ "analog command for velocity loop", DoAnalogCmdForVelLoop, MOTIONMODE::VMode },
+{ "sine generation for position loop", DoSinGenForPosLoop, MOTIONMODE::PMode },
+{ "velocity loop PID", DoVelLoopPidCtrl, MOTIONMODE::TMode },
+{ "ratchet effect", DoRatchetEffect, MOTIONMODE::TMode },
+{ "edge effect", DoEdgeEffect, MOTIONMODE::TMode },
+{ "smooth effect", DoSmoothEffect, MOTIONMODE::TMode },
+{ "damp effect", DoDampEffect, MOTIONMODE::TMode },
+{ "frequency response", DoFreqResponse, MOTIONMODE::TMode },
+{ "haptic effect pipeline", DoEffectPipeline, MOTIONMODE::TMode },
+{ "setpoint stream for position loop", DoStreamForPosLoop, MOTIONMODE::PMode },
+{ "velocity loop autotune", DoVelLoopAutotune, MOTIONMODE::TMode },
+{ "friction identification", DoFrictionIdent, MOTIONMODE::TMode }, };
+
+const int autotuneSilFunc = 11;	// DoVelLoopAutotune
+const int identSilFunc = 12;	// DoFrictionIdent
+
+const int defaultSilFunc = 9;	// DoEffectPipeline
+
+ModeManager modeManager
+{ cRTaxis, MAX_AXES, silFuncTable, sizeof(silFuncTable) / sizeof(silFuncTable[0]) };
+
+/**
+ * Deadline monitor of the SYNC callback, falls back to a cheap function
+ * after OVERRUN_ESCALATE consecutive overruns.
+ */
+RtWatchdog watchdog
+{ modeManager, SYNC_PERIOD_NS, OVERRUN_ESCALATE };
+
+/**
+ * RT tasks of the SYNC callback and their rate, the SIL function runs
+ * every cycle, the slow tasks are staggered by the executive.
+ */
+const CyclicExecutive::Task rtTaskTable[] =
+{
+{ "observers", UpdateObservers, 1, 0, 2.0 },
+{ "analog input", UpdateAnalogInput, 1, 0, 1.0 },
+{ "SIL function", RunSilFunction, 1, 0, 20.0 },
+{ "scope", RecordScope, 1, 0, 1.0 },
+{ "axis monitor", MonitorAxes, 10, CyclicExecutive::AUTO_PHASE, 2.0 },
+{ "offload results", DispatchOffloadResults, 4, CyclicExecutive::AUTO_PHASE, 1.0 }, };
+
+CyclicExecutive executive
+{ rtTaskTable, sizeof(rtTaskTable) / sizeof(rtTaskTable[0]) };
+
+/**
+ * Worker pool for the computations too heavy for one sync cycle, jobs are
+ * posted by the RT tasks, results dispatched by DispatchOffloadResults().
+ */
+OffloadPool offload;
+
+/**
+ * RT profile: memory part applied to the process in main(), scheduling part
+ * only to the thread creating the SYNC timer, see SILInit().
+ */
+RtProcess::RtProfile rtProfile;
+RtProcess::RtReport rtReport;
+
+std::atomic<unsigned int> axisFaultMask
+{ 0 };	// bit i -> axis i in error stop, see MonitorAxes()
+
+/**
+ * Position / velocity / disturbance observers of all axes, updated at the
+ * start of every sync cycle, their velocity replaces GetActualVelocity()
+ * in the velocity loop and the haptic effects.
+ */
+StateObserver velObserver[MAX_AXES];
+
+/**
+ * Velocity loop controllers of all axes, updated in one pass per sync cycle.
+ */
+#define VEL_LOOP_LIMIT	1.0
+PIDBank<MAX_AXES> pidVelocity
+{ SYNC_PERIOD_NS * 1e-9 };
+
+/**
+ * Velocity loop gains versus speed / position / load, loaded from
+ * schedule.txt, they replace the Modbus gains while enabled, see
+ * ConfigureGainSchedule().
+ */
+GainSchedule<> velGainSchedule;
+
+/**
+ * Velocity loop tunables, written as one set by the Modbus loop and
+ * picked up by the RT loop on the next sync cycle.
+ */
+struct VelLoopParams
+{
+	double targetVelocity;
+	double kp;
+	double ki;
+	double kd;
+};
+
+ParamBlock<VelLoopParams> velLoopParams
+{
+{ targetVelocity, vel_kp, vel_ki, vel_kd } };
+std::atomic<unsigned int> velLoopParamsApplied
+{ 0 };	// generation in effect on the RT side
+
+/**
+ * Scale of the velocity loop gains in the registers 2 / 3. The controllers
+ * run at the sync period (they assumed 1 ms before), the ki register keeps
+ * its meaning: a value gives the same integral step per cycle as with the
+ * 1 ms period, ki = register / 250 1/s at 250 us.
+ */
+#define KP_REGISTER_SCALE	10000.0
+#define KI_REGISTER_SCALE	(1000.0 * SYNC_PERIOD_NS / 1000000.0)
+
+/**
+ * Exact gains of the last autotune. Registers 2 / 3 only hold them rounded
+ * to their step, the read-back of these values keeps the exact gains until
+ * one of the registers is written with another value, see ReadMbusInput().
+ */
+struct TunedGains
+{
+	bool active;
+	short kpRegister;
+	short kiRegister;
+	double kp;
+	double ki;
+};
+
+TunedGains tunedGains =
+{ false, 0, 0, 0.0, 0.0 };
+
+/**
+ * Excitation generators of all axes, used in position loop by DoSinGenForPosLoop,
+ * reconfigure at run time by SignalGenerator::Configure() from the non-RT side.
+ * Sampled once per sync cycle, the array needs a default constructor.
+ */
+struct SyncSignalGenerator: SignalGenerator
+{
+	SyncSignalGenerator() :
+			SignalGenerator(SYNC_PERIOD_NS * 1e-9)
+	{
+	}
+};
+SyncSignalGenerator sigGen[MAX_AXES];
+
+/**
+ * Frequency response of axis FRA_AXIS, the chirp is injected on top of the
+ * torque (TMode) or velocity (VMode) command by DoFreqResponse.
+ */
+#define FRA_AXIS		0
+FreqResponseAnalyzer fra
+{ SYNC_PERIOD_NS * 1e-9 };
+
+/**
+ * Haptic effects of all axes chained at run time, see ConfigureEffects().
+ * Run once per sync cycle, the array needs a default constructor.
+ */
+#define MAX_EFFECTS		8
+struct SyncEffectPipeline: EffectPipeline<MAX_EFFECTS>
+{
+	SyncEffectPipeline() :
+			EffectPipeline<MAX_EFFECTS>(SYNC_PERIOD_NS * 1e-9)
+	{
+	}
+};
+SyncEffectPipeline hapticPipeline[MAX_AXES];
+
+/**
+ * Detent profiles of all axes, built in SILInit() before the timer starts,
+ * used by DoRatchetEffect and by the pipeline (effect mask bit4).
+ */
+TorqueMap detentMap[MAX_AXES];
+
+/**
+ * Walls / keep-out zones of all axes, published in SILInit(), used by
+ * DoEdgeEffect and by the pipeline (effect mask bit5).
+ */
+VirtualFixtures<1> edgeFixtures[MAX_AXES];
+
+/**
+ * Notch + low-pass on the torque commands and low-pass on the velocity
+ * feedback of all axes, pass-through until set through Modbus, see
+ * ConfigureFilters().
+ */
+BiquadBank<MAX_AXES, 2> torqueFilter
+{ SYNC_PERIOD_NS * 1e-9 };
+BiquadBank<MAX_AXES, 1> velocityFilter
+{ SYNC_PERIOD_NS * 1e-9 };
+
+/**
+ * Analog velocity command, read from the drive of ANALOG_AXIS and
+ * conditioned once per sync cycle by UpdateAnalogInput(), fanned out to all
+ * axes by DoAnalogCmdForVelLoop with analogScale[] counts/s at full scale.
+ */
+#define ANALOG_AXIS			0
+#define ANALOG_PI_OFFSET	6
+AnalogConditioner analogCommand
+{ SYNC_PERIOD_NS * 1e-9 };
+double analogScale[MAX_AXES] =
+{ 0.0 };
+
+/**
+ * Position setpoints of all axes streamed by a background thread from
+ * trajectory.txt, interpolated to the sync rate by DoStreamForPosLoop.
+ */
+typedef SetpointStream<MAX_AXES> PosStream;
+PosStream posStream
+{ SYNC_PERIOD_NS * 1e-9 };
+std::thread streamProducer;
+std::atomic<bool> streamCancel
+{ false };
 
 /**
- * Set the motion mode and function want to be run
+ * Triggered capture of axis SCOPE_AXIS, armed through Modbus, fed by
+ * RecordScope() at the end of every sync cycle, written to scope.txt.
  */
-auto currentSilFunc = DoSmoothEffect;
-MOTIONMODE currentMotionMode = MOTIONMODE::TMode;
+#define SCOPE_AXIS		0
+ScopeCapture scope
+{ SYNC_PERIOD_NS * 1e-9 };
 
-PIDController pidVelocity
-{ vel_kp, vel_ki, 0.0f, 1000.0, 1.0, 0.001 };
+/**
+ * Relay feedback experiment on the velocity loop of TUNE_AXIS, started by
+ * switching to DoVelLoopAutotune, the gains are applied by the Modbus loop
+ * to all axes, see ApplyAutotune().
+ */
+#define TUNE_AXIS		0
+RelayAutotune autotune
+{ SYNC_PERIOD_NS * 1e-9 };
+
+/**
+ * Friction / gravity feedforward of all axes, added to the torque of the
+ * haptic effects, see ConfigureFeedforward(). The model of IDENT_AXIS is
+ * fitted by the velocity sweeps of DoFrictionIdent, its gravity table over
+ * GRAVITY_PERIOD double buffered in gravityMap[].
+ */
+#define IDENT_AXIS		0
+#define GRAVITY_PERIOD	10000.0		// counts, one motor turn
+FeedforwardModel feedforward[MAX_AXES];
+FrictionIdentifier frictionIdent
+{ SYNC_PERIOD_NS * 1e-9 };
+FeedforwardParams identifiedModel;
+TorqueMap gravityMap[2];
+int gravityMapIndex = 0;
+
+/**
+ * Least squares fit of a finished sweep, too heavy for the sync cycle and
+ * the Modbus loop: DoFrictionIdent() copies the level means to
+ * frictionSweep and posts it to the offload pool, FrictionFitDone() hands
+ * the result over, ApplyFrictionIdent() applies it. Local -> the job could
+ * not be posted, the Modbus loop fits by itself. No sweep is started while
+ * a fit is Posted, the worker reads frictionSweep until then.
+ */
+#define FRICTION_FIT_JOB	1
+enum class FIT
+{
+	Idle, Posted, Ready, Local,
+};
+std::atomic<FIT> frictionFit
+{ FIT::Idle };
+OffloadResult frictionFitResult;	// valid in Ready
+
+struct FrictionSweep
+{
+	int count;
+	double velocity[2 * IdentParams::MAX_LEVELS];	// counts/s, level means
+	double torque[2 * IdentParams::MAX_LEVELS];
+};
+FrictionSweep frictionSweep;	// written by the RT side in Idle only
 
 #define TEST_COUNT		200000
 static unsigned int recordArray[TEST_COUNT] =
@@ -87,18 +415,30 @@ public:
 	Timer(const char* name) :
 			m_name(name)
 	{
-		start = std::chrono::high_resolution_clock::now();
+		start = std::chrono::steady_clock::now();
 	}
 
 	~Timer()
 	{
-		auto dur = std::chrono::high_resolution_clock::now() - start;
+		auto dur = std::chrono::duration_cast<std::chrono::microseconds>(
+				std::chrono::steady_clock::now() - start);
 		std::cout << "function: " << m_name << " took: [" << dur.count()
 				<< " us]\n";
 	}
 #endif
 };
 
+/*
+ * Benchmarks run instead of the program by a command line switch, no
+ * connection to the Maestro needed, see BenchJitter() / BenchOffload().
+ * 	--bench-jitter	wake-up jitter of a SYNC_PERIOD_NS periodic loop before
+ * 					and after the RT profile is applied.
+ * 	--bench-offload	RT-side cost and latency of the offload pool, posting
+ * 					from a thread with the RT profile.
+ */
+#define RT_JITTER_CYCLES	20000
+#define OFFLOAD_BENCH_JOBS	10000
+
 #define MEASUREMENT	0
 #if	MEASUREMENT
 #define TIMER()	Timer timer(__PRETTY_FUNCTION__)
@@ -153,6 +493,18 @@ int main(int argc, char *argv[])
 		// System log file location: /var/log/syslog
 		syslog(LOG_DEBUG, "the program <%s> is working\n", argv[0]);
 
+		if ((argc > 1) && !strcmp(argv[1], "--bench-jitter"))
+			return BenchJitter();
+
+		// memory part of the RT profile, before anything is allocated
+		rtProfile.cpuMask = RT_CPU_MASK;
+
+		if (!RtProcess::ApplyProcess(rtProfile, rtReport))
+			std::cerr << "RT profile not fully applied\n";
+
+		if ((argc > 1) && !strcmp(argv[1], "--bench-offload"))
+			return BenchOffload();
+
 		// Initialize system, axes and all needed initializations
 		MainInit();
 
@@ -183,16 +535,51 @@ int main(int argc, char *argv[])
  * HoldingRegister[0] -> terminate the programm.
  * HoldingRegister[1] -> set target velocity, unit: rpm.
  * HoldingRegister[2] -> velocity loop kp.
- * HoldingRegister[3] -> velocity loop ki.
+ * HoldingRegister[3] -> velocity loop ki, see KI_REGISTER_SCALE.
+ * HoldingRegister[4] -> start the frequency response measurement.
+ * HoldingRegister[5] -> haptic effect mask, see ConfigureEffects().
+ * HoldingRegister[6] -> SIL function, 1 based index of silFuncTable.
+ * HoldingRegister[7] -> arm the scope capture on 0 -> 1, 0 disarms.
+ * HoldingRegister[8] -> scope trigger, low byte CHANNEL, high byte TRIGGER.
+ * HoldingRegister[9] -> scope trigger level (torque: 1/1000) or bit pattern.
+ * HoldingRegister[10] -> scope trigger bit mask.
+ * HoldingRegister[11..15] -> torque / velocity filters, see ConfigureFilters().
+ * HoldingRegister[16] -> stream trajectory.txt on 0 -> 1, 0 cancels.
+ * HoldingRegister[17] -> autotune rule, see TUNING.
+ * HoldingRegister[18] -> feedforward mask, see ConfigureFeedforward().
+ * HoldingRegister[19] -> velocity loop gain schedule, see ConfigureGainSchedule().
  */
 void ReadMbusInput(void)
 {
-	MBus.MbusReadHoldingRegisterTable(0, 4, mbus_read_out);
+	MBus.MbusReadHoldingRegisterTable(0, 20, mbus_read_out);
 
 	giTerminate = mbus_read_out.regArr[0];
 	targetVelocity = static_cast<double>(mbus_read_out.regArr[1]);
-	vel_kp = static_cast<double>(mbus_read_out.regArr[2] / 10000.0);
-	vel_ki = static_cast<double>(mbus_read_out.regArr[3] / 1000.0);
+	if (tunedGains.active && (mbus_read_out.regArr[2] == tunedGains.kpRegister)
+			&& (mbus_read_out.regArr[3] == tunedGains.kiRegister))
+	{
+		vel_kp = tunedGains.kp;
+		vel_ki = tunedGains.ki;
+	}
+	else
+	{
+		tunedGains.active = false;
+		vel_kp = static_cast<double>(mbus_read_out.regArr[2] / KP_REGISTER_SCALE);
+		vel_ki = static_cast<double>(mbus_read_out.regArr[3] / KI_REGISTER_SCALE);
+	}
+	fraStart = mbus_read_out.regArr[4];
+	effectMask = static_cast<unsigned short>(mbus_read_out.regArr[5]);
+	silFuncRequest = mbus_read_out.regArr[6];
+	scopeArm = mbus_read_out.regArr[7];
+	scopeTrigger = static_cast<unsigned short>(mbus_read_out.regArr[8]);
+	scopeLevel = mbus_read_out.regArr[9];
+	scopeMask = static_cast<unsigned short>(mbus_read_out.regArr[10]);
+	for (int i = 0; i < 5; ++i)
+		filterSetting[i] = mbus_read_out.regArr[11 + i];
+	streamStart = mbus_read_out.regArr[16];
+	tuneRule = mbus_read_out.regArr[17];
+	feedforwardMask = static_cast<unsigned short>(mbus_read_out.regArr[18]);
+	scheduleVariable = mbus_read_out.regArr[19];
 
 //	std::cout << vel_kp << " " << vel_ki << " " << " | ";
 
@@ -203,44 +590,639 @@ void UpdatePID(void)
 {
 	mbus_write_in.startRef = 2;
 	mbus_write_in.refCnt = 2;
-	mbus_write_in.regArr[0] = static_cast<short>(vel_kp * 10000.0);
-	mbus_write_in.regArr[1] = static_cast<short>(vel_ki * 1000.0);
+	mbus_write_in.regArr[0] = GainRegister(vel_kp, KP_REGISTER_SCALE);
+	mbus_write_in.regArr[1] = GainRegister(vel_ki, KI_REGISTER_SCALE);
 
 //	std::cout << mbus_write_in.regArr[0] << " " << mbus_write_in.regArr[1] << std::endl;
 
 	MBus.MbusWriteHoldingRegisterTable(mbus_write_in);
 
+	mbus_write_in.startRef = 20;
+	mbus_write_in.refCnt = 12;
+	mbus_write_in.regArr[0] = static_cast<short>(velLoopParamsApplied.load(
+			std::memory_order_relaxed));
+	mbus_write_in.regArr[1] = static_cast<short>(modeManager.GetIndex() + 1);
+	mbus_write_in.regArr[2] = static_cast<short>(watchdog.GetOverruns() & 0xFFFF);
+	mbus_write_in.regArr[3] = watchdog.IsEscalated() ? 1 : 0;
+	mbus_write_in.regArr[4] = static_cast<short>(scope.GetState());
+	mbus_write_in.regArr[5] = static_cast<short>(posStream.GetState());
+	mbus_write_in.regArr[6] = static_cast<short>(posStream.GetDepth());
+	mbus_write_in.regArr[7] = static_cast<short>(posStream.GetUnderruns() & 0xFFFF);
+	mbus_write_in.regArr[8] = static_cast<short>(axisFaultMask.load(
+			std::memory_order_relaxed));
+	mbus_write_in.regArr[9] = static_cast<short>(executive.GetMaxLoad() / 1000);
+	mbus_write_in.regArr[10] = static_cast<short>(autotune.GetState());
+	mbus_write_in.regArr[11] = static_cast<short>(frictionIdent.GetState());
+
+	MBus.MbusWriteHoldingRegisterTable(mbus_write_in);
+
 	return;
 }
 
-void MainLoop(void)
-{
+/*
+ * Build the haptic chain of all axes from the Modbus bit mask,
+ * the RT side switches to it on the next cycle.
+ */
+void ConfigureEffects(unsigned short mask)
+{
+	if (mask == 0)
+		mask = 0x1;
+
+	for (int i = 0; i < MAX_AXES; ++i)
+	{
+		EffectPipeline<MAX_EFFECTS>::Config config
+		{ };
+		config.limit = 2.0;
+
+		if (mask & 0x1)
+		{
+			config.effect[config.count].kind = EFFECT::Smooth;
+			config.effect[config.count++].smooth =
+			{ 0.0001, 1000.0, 0.05 };
+		}
+		if (mask & 0x2)
+		{
+			config.effect[config.count].kind = EFFECT::Damp;
+			config.effect[config.count++].damp =
+			{ 0.0001 };
+		}
+		if (mask & 0x4)
+		{
+			config.effect[config.count].kind = EFFECT::Ratchet;
+			config.effect[config.count++].ratchet =
+			{ 10000 / 10, 0.0008, 10000.0, 2.0 };
+		}
+		if (mask & 0x8)
+		{
+			config.effect[config.count].kind = EFFECT::Wall;
+			config.effect[config.count++].wall =
+			{ initPos[i] - 2500, initPos[i] + 2500, 0.01, 10000.0, 2.0 };
+		}
+		if (mask & 0x10)
+		{
+			config.effect[config.count].kind = EFFECT::Map;
+			config.effect[config.count++].map =
+			{ &detentMap[i], 1.0 };
+		}
+		if (mask & 0x20)
+		{
+			config.effect[config.count].kind = EFFECT::Fixture;
+			config.effect[config.count++].fixture =
+			{ &edgeFixtures[i] };
+		}
+
+		hapticPipeline[i].Configure(config);
+	}
+}
+
+/*
+ * Walls at initPos +/- 2500 counts, add keep-out intervals here as needed.
+ */
+void PublishEdgeFixtures(int axis)
+{
+	typedef VirtualFixtures<1> Fixtures;
+
+	Fixtures::Fixture fixtures[2];
+	double below = -1.0, above = 1.0;
+
+	fixtures[0] = Fixtures::HalfSpace(&below, -(initPos[axis] - 2500), 0.01, 0.0);
+	fixtures[1] = Fixtures::HalfSpace(&above, initPos[axis] + 2500, 0.01, 0.0);
+
+	edgeFixtures[axis].Publish(fixtures, 2);
+}
+
+/*
+ * Design the filters of all axes from the Modbus registers, the RT side
+ * switches to them on the next cycle.
+ * filterSetting[0] -> torque notch frequency, Hz, 0 -> off.
+ * filterSetting[1] -> torque notch Q * 100, 0 -> 1.
+ * filterSetting[2] -> torque notch depth, dB, 0 -> full band-stop.
+ * filterSetting[3] -> torque low-pass frequency, Hz, 0 -> off.
+ * filterSetting[4] -> velocity feedback low-pass frequency, Hz, 0 -> off.
+ */
+void ConfigureFilters(void)
+{
+	BiquadSection notch;
+	notch.type = (filterSetting[2] > 0) ? FILTER::Notch : FILTER::BandStop;
+	if (filterSetting[0] <= 0)
+		notch.type = FILTER::None;
+	notch.frequency = filterSetting[0];
+	notch.q = (filterSetting[1] > 0) ? filterSetting[1] / 100.0 : 1.0;
+	notch.depth = filterSetting[2];
+
+	BiquadSection torqueLowPass;
+	torqueLowPass.type = (filterSetting[3] > 0) ? FILTER::LowPass : FILTER::None;
+	torqueLowPass.frequency = filterSetting[3];
+
+	BiquadSection velocityLowPass;
+	velocityLowPass.type = (filterSetting[4] > 0) ? FILTER::LowPass : FILTER::None;
+	velocityLowPass.frequency = filterSetting[4];
+
+	for (int i = 0; i < MAX_AXES; ++i)
+	{
+		torqueFilter.SetSection(i, 0, notch);
+		torqueFilter.SetSection(i, 1, torqueLowPass);
+		velocityFilter.SetSection(i, 0, velocityLowPass);
+	}
+
+	torqueFilter.Apply();
+	velocityFilter.Apply();
+}
+
+/*
+ * Background producer of posStream, one setpoint per line of trajectory.txt:
+ * time [s] and the position of every axis [counts], relative to where the
+ * axes are when the stream starts.
+ */
+void StreamTrajectory(void)
+{
+	std::ifstream input("trajectory.txt");
+	if (!input.is_open())
+	{
+		std::cerr << "can not open trajectory.txt\n";
+		return;
+	}
+
+	// a previous stream may have left it stopped or setpoints queued, only
+	// the RT side can restart and flush it.
+	posStream.Rearm();
+	while (!posStream.IsRearmed())
+	{
+		if (streamCancel.load())
+			return;
+		usleep(1000);
+	}
+
+	double offset[MAX_AXES];
+	for (int i = 0; i < MAX_AXES; ++i)
+		offset[i] = cRTaxis[i].GetActualPosition();
+
+	PosStream::Setpoint setpoint;
+	setpoint.last = false;
+	int count = 0;
+
+	while (input >> setpoint.time)
+	{
+		for (int i = 0; i < MAX_AXES; ++i)
+		{
+			input >> setpoint.position[i];
+			setpoint.position[i] += offset[i];
+		}
+
+		// the queue covers the jitter of this thread, wait while it is full.
+		while (!posStream.Push(setpoint))
+		{
+			if (streamCancel.load()
+					|| (posStream.GetState() == PosStream::STATE::Stopped))
+			{
+				std::cerr << "trajectory stream aborted after " << count
+						<< " setpoints\n";
+				return;
+			}
+			usleep(1000);
+		}
+		++count;
+	}
+
+	// the last one again, the stream stops there instead of running dry.
+	setpoint.last = true;
+	while (!posStream.Push(setpoint) && !streamCancel.load())
+		usleep(1000);
+
+	std::cout << "trajectory streamed, " << count << " setpoints\n";
+}
+
+void StopStream(void)
+{
+	streamCancel.store(true);
+	if (streamProducer.joinable())
+		streamProducer.join();
+}
+
+void StartStream(void)
+{
+	StopStream();
+	streamCancel.store(false);
+	streamProducer = std::thread(StreamTrajectory);
+}
+
+/*
+ * Scope trigger from the Modbus registers, window lengths and
+ * decimation keep the ScopeParams defaults.
+ */
+ScopeParams GetScopeParams(void)
+{
+	ScopeParams params;
+
+	params.channel = static_cast<CHANNEL>((scopeTrigger & 0xFF) % ScopeCapture::CHANNELS);
+	params.trigger = static_cast<TRIGGER>(((scopeTrigger >> 8) & 0xFF) % 4);
+
+	if (params.channel == CHANNEL::Torque)
+		params.level = scopeLevel / 1000.0;
+	else
+		params.level = scopeLevel;
+
+	params.mask = scopeMask;
+	params.pattern = static_cast<unsigned short>(scopeLevel);
+
+	return params;
+}
+
+TUNING GetTuningRule(void)
+{
+	if ((tuneRule < 0) || (tuneRule >= RelayAutotune::RULES))
+		return TUNING::ZieglerNicholsPI;
+
+	return static_cast<TUNING>(tuneRule);
+}
+
+/*
+ * Register value of a gain, rounded to the register step and clamped to
+ * its range.
+ */
+short GainRegister(double gain, double scale)
+{
+	return static_cast<short>(std::min(std::max(std::round(gain * scale), 0.0),
+			static_cast<double>(std::numeric_limits<short>::max())));
+}
+
+/*
+ * Gains of a finished autotune replace vel_kp / vel_ki / vel_kd, published
+ * exactly to all axes as one set like the Modbus ones and written back,
+ * rounded, to the registers 2 / 3 by UpdatePID(), see TunedGains.
+ */
+void ApplyAutotune(void)
+{
+	RelayAutotune::STATE state = autotune.GetState();
+
+	if (state == RelayAutotune::STATE::Failed)
+	{
+		std::cerr << "autotune failed, no oscillation of axis " << TUNE_AXIS
+				<< " measured\n";
+		autotune.Reset();
+		return;
+	}
+
+	if (state != RelayAutotune::STATE::Done)
+		return;
+
+	TUNING rule = GetTuningRule();
+	double kp = 0.0, ki = 0.0, kd = 0.0;
+
+	autotune.GetGains(rule, kp, ki, kd);
+
+	std::cout << "autotune: Ku " << autotune.GetUltimateGain() << ", Pu "
+			<< autotune.GetUltimatePeriod() * 1000.0 << " ms, amplitude "
+			<< autotune.GetAmplitude() << ", " << RelayAutotune::GetName(rule)
+			<< ": kp " << kp << ", ki " << ki << ", kd " << kd << "\n";
+
+	// exact gains published, kept over the rounded read-back of UpdatePID().
+	tunedGains =
+	{ true, GainRegister(kp, KP_REGISTER_SCALE), GainRegister(ki,
+			KI_REGISTER_SCALE), kp, ki };
+	vel_kp = kp;
+	vel_ki = ki;
+	vel_kd = kd;
+
+	autotune.Reset();
+}
+
+/*
+ * Feedforward of all axes from the Modbus bit mask, with the model
+ * identified on IDENT_AXIS (the other axes have none yet):
+ * bit0 -> Coulomb / viscous / Stribeck friction.
+ * bit1 -> gravity / cogging, table over GRAVITY_PERIOD or constant offset.
+ */
+void ConfigureFeedforward(unsigned short mask)
+{
+	for (int i = 0; i < MAX_AXES; ++i)
+	{
+		FeedforwardParams params;
+
+		if (i == IDENT_AXIS)
+		{
+			if (mask & 0x1)
+			{
+				params.coulomb = identifiedModel.coulomb;
+				params.viscous = identifiedModel.viscous;
+				params.stribeck = identifiedModel.stribeck;
+				params.stribeckVelocity = identifiedModel.stribeckVelocity;
+			}
+
+			if (mask & 0x2)
+			{
+				params.offset = identifiedModel.offset;
+				params.map = identifiedModel.map;
+			}
+		}
+
+		feedforward[i].Configure(params);
+	}
+}
+
+/*
+ * Model of a finished sweep: friction from the offload fit, gravity table
+ * built in the map not in use (offset 0 then, it is part of the table),
+ * applied through ConfigureFeedforward() with the current mask. The table
+ * is not rebuilt while the RT side may still evaluate that map.
+ */
+void ApplyFrictionIdent(void)
+{
+	if (frictionIdent.GetState() != FrictionIdentifier::STATE::Done)
+		return;
+
+	FeedforwardParams model;
+	double rms = 0.0;
+	bool fitted = false;
+
+	switch (frictionFit.load(std::memory_order_acquire))
+	{
+	case FIT::Idle:
+	case FIT::Posted:
+		return;	// fit not back yet
+
+	case FIT::Ready:
+		fitted = (frictionFitResult.status == 0);
+		model.coulomb = frictionFitResult.value[0];
+		model.viscous = frictionFitResult.value[1];
+		model.stribeck = frictionFitResult.value[2];
+		model.stribeckVelocity = frictionFitResult.value[3];
+		model.offset = frictionFitResult.value[4];
+		rms = frictionFitResult.value[5];
+		break;
+
+	case FIT::Local:
+		fitted = frictionIdent.Fit(model, &rms);
+		break;
+	}
+
+	if (fitted)
+	{
+		// the map in use stays untouched, the other one is free only once
+		// the RT side has picked up the model of the previous sweep.
+		int next = gravityMapIndex ^ 1;
+
+		if (!feedforward[IDENT_AXIS].IsCurrent())
+			std::cerr << "gravity table not rebuilt, the previous one is not "
+					"picked up yet (run an effect first)\n";
+		else if (frictionIdent.BuildMap(gravityMap[next]))
+		{
+			model.map = &gravityMap[next];
+			model.offset = 0.0;
+			gravityMapIndex = next;
+		}
+
+		identifiedModel = model;
+		ConfigureFeedforward(feedforwardMask);
+
+		std::cout << "friction identified: Coulomb " << model.coulomb
+				<< ", viscous " << model.viscous << ", Stribeck " << model.stribeck
+				<< " below " << model.stribeckVelocity << " counts/s, offset "
+				<< model.offset << (model.map ? ", gravity table" : "")
+				<< ", rms error " << rms << "\n";
+	}
+	else
+		std::cerr << "friction identification failed, too few levels\n";
+
+	if (frictionIdent.Write("friction.txt"))
+		std::cout << "friction sweep written to friction.txt\n";
+	else
+		std::cerr << "can not write friction.txt\n";
+
+	// back to Idle by Write(), the next sweep may post again.
+	frictionFit.store(FIT::Idle, std::memory_order_release);
+}
+
+/*
+ * Velocity loop gain schedule indexed by 'variable' (0 -> off, 1 -> speed,
+ * 2 -> position, 3 -> load estimate, see SCHEDULE), breakpoints read from
+ * schedule.txt, one per line:
+ * 	x kp ki kd limit
+ * x in counts/s, counts or torque command unit (|disturbance| of the
+ * observer), ascending, limit > 0, lines starting with '#' skipped. The
+ * load estimate needs OBSERVER_TORQUE_GAIN, it is 0 without it.
+ */
+void ConfigureGainSchedule(short variable)
+{
+	double x[GainSchedule<>::MAX_POINTS];
+	GainSet gains[GainSchedule<>::MAX_POINTS];
+	int count = 0;
+
+	if ((variable == static_cast<short>(SCHEDULE::Load))
+			&& (velObserver[0].GetTorqueGain() == 0.0))
+	{
+		std::cerr << "no load estimate, set OBSERVER_TORQUE_GAIN to schedule on the load\n";
+		return;
+	}
+
+	if ((variable > 0) && (variable <= static_cast<short>(SCHEDULE::Load)))
+	{
+		std::ifstream input("schedule.txt");
+		if (!input.is_open())
+		{
+			std::cerr << "can not open schedule.txt\n";
+			return;
+		}
+
+		std::string line;
+		while (std::getline(input, line) && (count < GainSchedule<>::MAX_POINTS))
+		{
+			if (line.empty() || (line[0] == '#'))
+				continue;
+
+			GainSet& set = gains[count];
+			if (sscanf(line.c_str(), "%lf %lf %lf %lf %lf", &x[count], &set.kp,
+					&set.ki, &set.kd, &set.limit) != 5)
+				continue;
+
+			// a 0 limit would silently take all the torque away.
+			if (!(set.limit > 0.0))
+			{
+				std::cerr << "invalid schedule.txt, limit must be > 0: " << line
+						<< "\n";
+				return;
+			}
+			++count;
+		}
+	}
+	else
+		variable = 0;
+
+	if (velGainSchedule.Configure(
+			count ? static_cast<SCHEDULE>(variable) : SCHEDULE::None, x, gains,
+			count))
+	{
+		if (count)
+			std::cout << "velocity loop gain schedule: " << count
+					<< " breakpoints\n";
+		else
+			std::cout << "velocity loop gain schedule off\n";
+	}
+	else
+		std::cerr << "invalid schedule.txt, x must be ascending\n";
+}
+
+void MainLoop(void)
+{
+
+	struct sigaction SigAction;
+
+	SigAction.sa_handler = TerminateApplication;
+
+	sigaction(SIGINT, &SigAction, NULL);
+
+	while (!giTerminate)
+	{
+
+		ReadMbusInput();
+
+		if (isTestFinished)
+		{
+			std::cout << "SIL Test is done\n";
+			break;
+		}
+
+		if (autotune.GetState() != RelayAutotune::STATE::Running)
+			ApplyAutotune();
+
+		// publish the whole set at once, the RT loop applies it on the next cycle.
+		if ((prev_target_velocity != targetVelocity) || (prev_vel_kp != vel_kp)
+				|| (prev_vel_ki != vel_ki) || (prev_vel_kd != vel_kd))
+		{
+			velLoopParams.Publish(
+			{ targetVelocity, vel_kp, vel_ki, vel_kd });
+			prev_target_velocity = targetVelocity;
+			prev_vel_kp = vel_kp;
+			prev_vel_ki = vel_ki;
+			prev_vel_kd = vel_kd;
+		}
+
+		if ((silFuncRequest > 0) && (silFuncRequest != prev_sil_func_request))
+		{
+			// blocks until the op-mode transition is done, Modbus is polled again afterwards.
+			autotune.Abort();
+			frictionIdent.Abort();
+
+			if ((silFuncRequest - 1 == identSilFunc)
+					&& (frictionFit.load(std::memory_order_acquire) == FIT::Posted))
+				std::cerr << "friction fit of the last sweep still running, "
+						"select the identification again\n";
+			else if (modeManager.Switch(silFuncRequest - 1))
+			{
+				watchdog.Rearm();
+				std::cout << "SIL function: "
+						<< modeManager.GetEntry(silFuncRequest - 1).name << "\n";
+
+				if ((silFuncRequest - 1 == autotuneSilFunc)
+						&& autotune.Start(AutotuneParams()))
+					std::cout << "autotune started, "
+							<< RelayAutotune::GetName(GetTuningRule()) << "\n";
+
+				if (silFuncRequest - 1 == identSilFunc)
+				{
+					IdentParams ident;
+					ident.period = GRAVITY_PERIOD;
+					if (frictionIdent.Start(ident))
+					{
+						// a fit of the previous sweep not applied yet is dropped.
+						frictionFit.store(FIT::Idle, std::memory_order_release);
+						std::cout << "friction identification started\n";
+					}
+				}
+			}
+			else
+				std::cerr << "can not switch to SIL function " << silFuncRequest
+						<< "\n";
+		}
+		prev_sil_func_request = silFuncRequest;
+
+		if (effectMask != prev_effect_mask)
+		{
+			ConfigureEffects(effectMask);
+			prev_effect_mask = effectMask;
+		}
+
+		ApplyFrictionIdent();
+
+		if (scheduleVariable != prev_schedule_variable)
+		{
+			ConfigureGainSchedule(scheduleVariable);
+			prev_schedule_variable = scheduleVariable;
+		}
+
+		if (feedforwardMask != prev_feedforward_mask)
+		{
+			ConfigureFeedforward(feedforwardMask);
+			prev_feedforward_mask = feedforwardMask;
+		}
 
-	struct sigaction SigAction;
+		if (!std::equal(filterSetting, filterSetting + 5, prev_filter_setting))
+		{
+			ConfigureFilters();
+			std::copy(filterSetting, filterSetting + 5, prev_filter_setting);
+		}
 
-	SigAction.sa_handler = TerminateApplication;
+		if (streamStart != prev_stream_start)
+		{
+			if (streamStart)
+				StartStream();
+			else
+				StopStream();
+			prev_stream_start = streamStart;
+		}
 
-	sigaction(SIGINT, &SigAction, NULL);
+		if (fraStart && !prev_fra_start)
+		{
+			FreqResponseParams params;
+			if (fra.Start(params))
+				std::cout << "frequency response measurement started\n";
+			else
+				std::cerr << "frequency response not started, already running or sweep outside (0, fs/2)\n";
+		}
+		prev_fra_start = fraStart;
 
-	while (!giTerminate)
-	{
+		if (fra.GetState() == FreqResponseAnalyzer::STATE::Done)
+		{
+			if (fra.WriteBode("bode.txt"))
+				std::cout << "frequency response written to bode.txt\n";
+			else
+				std::cerr << "can not write bode.txt\n";
+		}
 
-		ReadMbusInput();
+		if (scopeArm != prev_scope_arm)
+		{
+			if (scopeArm)
+				scopeArmPending = true;
+			else
+			{
+				scopeArmPending = false;
+				scope.Disarm();
+			}
+			prev_scope_arm = scopeArm;
+		}
 
-		if (isTestFinished)
+		// a capture still running is dropped, the RT side needs one cycle to let it go.
+		if (scopeArmPending)
 		{
-			std::cout << "SIL Test is done\n";
-			break;
+			if (scope.Arm(GetScopeParams()))
+			{
+				scopeArmPending = false;
+				std::cout << "scope capture armed\n";
+			}
+			else
+				scope.Disarm();
 		}
 
-		if ((pidVelocity.GetKi() != vel_ki) || (pidVelocity.GetKp() != vel_kp))
+		if (scope.GetState() == ScopeCapture::STATE::Done)
 		{
-			pidVelocity.SetKi(vel_ki);
-			pidVelocity.SetKp(vel_kp);
+			if (scope.Write("scope.txt"))
+				std::cout << "scope capture written to scope.txt\n";
+			else
+				std::cerr << "can not write scope.txt\n";
 		}
 
 		UpdatePID();
-		usleep(500000);
+		usleep(MAIN_LOOP_PERIOD_US);
 
 	}
 
@@ -252,66 +1234,145 @@ void SILInit(void)
 
 	MMC_DestroySYNCTimer(gConnHndl);
 
+	// all axes in the op-mode of the start-up function, command source set to user, powered on.
+	AxisBringUp bringUp(cRTaxis, MAX_AXES);
+	const int failed = bringUp.Run(silFuncTable[defaultSilFunc].mode);
+	bringUp.Report();
+
+	if (failed || !modeManager.Init(defaultSilFunc))
+	{
+		std::cerr << "can not bring up the axes for "
+				<< silFuncTable[defaultSilFunc].name << "\n";
+		giTerminate = true;
+		return;
+	}
+
+	std::cout << MAX_AXES << " axes ready in " << bringUp.GetElapsed() << " ms\n";
+
 	for (int i = 0; i < MAX_AXES; ++i)
 	{
-		// 0 - NC profiler
-		// 1 - 0;
-		// 2 - User
-		switch (currentMotionMode)
-		{
-		case MOTIONMODE::PMode:
-		{
-			cRTaxis[i].SetBoolParameter(0, MMC_UCUSER607A_SRC, 0);
-			cRTaxis[i].SetOpMode(OPM402_CYCLIC_SYNC_POSITION_MODE);
-			while (cRTaxis[i].GetOpMode() != OPM402_CYCLIC_SYNC_POSITION_MODE)
-				;
-			cRTaxis[i].SetBoolParameter(2, MMC_UCUSER607A_SRC, 0);
-			cRTaxis[i].SetUser607A(0.0f);
-			break;
-		}
-		case MOTIONMODE::VMode:
-		{
-			cRTaxis[i].SetBoolParameter(0, MMC_UCUSER60FF_SRC, 0);
-			cRTaxis[i].SetOpMode(OPM402_CYCLIC_SYNC_VELOCITY_MODE);
-			while (cRTaxis[i].GetOpMode() != OPM402_CYCLIC_SYNC_VELOCITY_MODE)
-				;
-			cRTaxis[i].SetBoolParameter(2, MMC_UCUSER60FF_SRC, 0);
-			cRTaxis[i].SetUser60FF(0.0f);
-			break;
-		}
-		case MOTIONMODE::TMode:
-		{
-			cRTaxis[i].SetBoolParameter(0, MMC_UCUSER6071_SRC, 0);
-			cRTaxis[i].SetOpMode(OPM402_CYCLIC_SYNC_TORQUE_MODE);
-			while (cRTaxis[i].GetOpMode() != OPM402_CYCLIC_SYNC_TORQUE_MODE)
-				;
-			cRTaxis[i].SetBoolParameter(2, MMC_UCUSER6071_SRC, 0);
-			cRTaxis[i].SetUser6071(0.0f);
-			break;
-		}
-		}
+		initPos[i] = cRTaxis[i].GetActualPosition();
 
-		usleep(1000);	// wait some time for ensure the mode changes done.
+		pidVelocity.SetGains(i, vel_kp, vel_ki, 0.0, 1000.0, VEL_LOOP_LIMIT);
 
-		cRTaxis[i].PowerOn();
+		ObserverParams observer;
+		observer.ts = SYNC_PERIOD_NS * 1e-9;
+		observer.torqueGain = OBSERVER_TORQUE_GAIN;
+		velObserver[i].Configure(observer);
 
-		while (!(cRTaxis[i].ReadStatus() & NC_AXIS_STAND_STILL_MASK))
-			usleep(10000);
+		SignalParams sine;
+		sine.waveform = WAVEFORM::Sine;
+		sine.amplitude = 10000.0;
+		sine.frequency = 1.0;
+		sigGen[i].Configure(sine);
 
-		initPos[i] = cRTaxis[i].GetActualPosition();
+		detentMap[i].BuildDetents(10000 / 10, 0.0008, 2.0);
+
+		analogScale[i] = 50.0 * 32767.0;	// 50 counts/s per raw unit
+
+		PublishEdgeFixtures(i);
+	}
+
+	ConfigureEffects(effectMask);
+
+	AnalogParams analog;
+	analog.rateLimit = 10.0;	// 0 -> full scale in 100ms
+	analog.cutoff = 50.0;
+	analogCommand.Configure(analog);
+
+	watchdog.SetFallback(MOTIONMODE::PMode, DoHoldCommand);
+	watchdog.SetFallback(MOTIONMODE::VMode, DoStopVelocity);
+	watchdog.SetFallback(MOTIONMODE::TMode, DoDampAllAxes);
 
+	if (!executive.Init())
+	{
+		giTerminate = true;
+		return;
 	}
 
+	offload.Register(FRICTION_FIT_JOB, FrictionFitWork, FrictionFitDone);
+
+	OffloadPool::WorkerParams workers;
+	workers.cpuMask = OFFLOAD_CPU_MASK;
+	workers.priority = OFFLOAD_PRIORITY;
+	if (!offload.Start(workers))
+		std::cerr << "can not start the offload workers\n";
+
+	RtGuard::Init();
+
+	// the SYNC thread inherits policy and affinity of the thread creating it:
+	// RT profile for the timer creation only, then back to housekeeping.
+	if (!RtProcess::ApplyThread(rtProfile, rtReport))
+		std::cerr << "RT profile not fully applied\n";
+	RtProcess::Print(rtReport);
+
 	MMC_CreateSYNCTimer(gConnHndl, []
-	{	currentSilFunc(); return 0;}, 1); // sync timer 1X
+	{
+		RT_SCOPE("SYNC");
+		watchdog.Begin();
+		executive.Run();
+		watchdog.End();
+		return 0;
+	}, 1); // sync timer 1X, slower tasks are run by the executive
 
 	// set user call-back function to highest priority -> 1.
 	// it must be set after CreateSyncTimer func, not before.
 	MMC_SetRTUserCallback(gConnHndl, 1);
 
+	if (!RtProcess::ResetThread(HOUSEKEEPING_CPU_MASK))
+		std::cerr << "main thread still on the RT profile\n";
+
 	return;
 
 }
+/*
+ * --bench-jitter: the same loop on the plain main thread, then with the
+ * whole RT profile (memory and the scheduling of the SYNC thread).
+ */
+int BenchJitter(void)
+{
+	RtProcess::Print("jitter before RT profile",
+			RtProcess::MeasureJitter(SYNC_PERIOD_NS, RT_JITTER_CYCLES));
+
+	rtProfile.cpuMask = RT_CPU_MASK;
+
+	bool applied = RtProcess::ApplyProcess(rtProfile, rtReport);
+	applied = RtProcess::ApplyThread(rtProfile, rtReport) && applied;
+	if (!applied)
+		std::cerr << "RT profile not fully applied\n";
+	RtProcess::Print(rtReport);
+
+	RtProcess::Print("jitter after RT profile",
+			RtProcess::MeasureJitter(SYNC_PERIOD_NS, RT_JITTER_CYCLES));
+
+	return 0;
+}
+
+/*
+ * --bench-offload: workers as in SILInit(), posted and polled every
+ * SYNC_PERIOD_NS by the main thread with the RT profile of the SYNC thread.
+ */
+int BenchOffload(void)
+{
+	OffloadPool::WorkerParams workers;
+	workers.cpuMask = OFFLOAD_CPU_MASK;
+	workers.priority = OFFLOAD_PRIORITY;
+	if (!offload.Start(workers))
+	{
+		std::cerr << "can not start the offload workers\n";
+		return -1;
+	}
+
+	if (!RtProcess::ApplyThread(rtProfile, rtReport))
+		std::cerr << "RT profile not fully applied\n";
+	RtProcess::Print(rtReport);
+
+	OffloadPool::Print(offload.Benchmark(SYNC_PERIOD_NS, OFFLOAD_BENCH_JOBS));
+	offload.Stop();
+
+	return 0;
+}
+
 /*
  ============================================================================
  Function:				MainInit()
@@ -402,29 +1463,21 @@ void MainClose(void)
 //
 	MMC_DestroySYNCTimer(gConnHndl);
 
+	offload.Stop();
+
+	StopStream();
+	if (posStream.GetUnderruns() > 0)
+		std::cout << "setpoint stream: " << posStream.GetUnderruns()
+				<< " underruns, lowest queue depth " << posStream.GetMinDepth()
+				<< "\n";
+
+	watchdog.Report();
+	executive.Report();
+	RtGuard::Report();
+
 	for (int i = 0; i < MAX_AXES; ++i)
 	{
-		switch (currentMotionMode)
-		{
-		case MOTIONMODE::PMode:
-		{
-			cRTaxis[i].SetUser607A(0.0f);
-			cRTaxis[i].SetBoolParameter(0, MMC_UCUSER607A_SRC, 0);
-			break;
-		}
-		case MOTIONMODE::VMode:
-		{
-			cRTaxis[i].SetUser60FF(0.0f);
-			cRTaxis[i].SetBoolParameter(0, MMC_UCUSER60FF_SRC, 0);
-			break;
-		}
-		case MOTIONMODE::TMode:
-		{
-			cRTaxis[i].SetUser6071(0.0f);
-			cRTaxis[i].SetBoolParameter(0, MMC_UCUSER6071_SRC, 0);
-			break;
-		}
-		}
+		ModeManager::LeaveOpMode(cRTaxis[i], modeManager.GetMotionMode());
 
 		cRTaxis[i].PowerOff();
 
@@ -583,48 +1636,8 @@ void Emergency_Received(unsigned short usAxisRef, short sEmcyCode)
 
 void DoSinGenForPosLoop(void)
 {
-	double rtb_SineWave;
-	double SineWave_AccFreqNorm = 0.0;
-	double SineWave_Frequency = 1.0;
-	int rtb_DataTypeConversion;
-
-	// S-Function (sdspsine2): '<Root>/Sine Wave'
-	rtb_SineWave = 10000.0f * sin(SineWave_AccFreqNorm);
-
-	// Update accumulated normalized freq value
-	// for next sample.  Keep in range [0 2*pi)
-	SineWave_AccFreqNorm += SineWave_Frequency * 0.0062831853071795866;
-	if (SineWave_AccFreqNorm >= 6.2831853071795862)
-	{
-		SineWave_AccFreqNorm -= 6.2831853071795862;
-	}
-	else
-	{
-		if (SineWave_AccFreqNorm < 0.0)
-		{
-			SineWave_AccFreqNorm += 6.2831853071795862;
-		}
-	}
-
-	// End of S-Function (sdspsine2): '<Root>/Sine Wave'
-
-	// DataTypeConversion: '<Root>/Data Type Conversion'
-	rtb_SineWave = floor(rtb_SineWave);
-//	  if (rtIsNaN(rtb_SineWave) || rtIsInf(rtb_SineWave)) {
-//	    rtb_SineWave = 0.0;
-//	  } else {
-//	    rtb_SineWave = fmod(rtb_SineWave, 4.294967296E+9);
-//	  }
-
-	// DataTypeConversion: '<Root>/Data Type Conversion'
-	rtb_DataTypeConversion =
-			rtb_SineWave < 0.0 ?
-					-static_cast<int>(static_cast<unsigned int>(-rtb_SineWave)) :
-					static_cast<int>(static_cast<unsigned int>(rtb_SineWave));
-
-	// S-Function (E607AWrite): '<Root>/E607AWrite'
-//	  Elmo_Write_607A(SineForPos_P.E607AWrite_p1, rtb_DataTypeConversion);
-	cRTaxis[0].SetUser607A(rtb_DataTypeConversion);
+	for (int i = 0; i < MAX_AXES; ++i)
+		cRTaxis[i].SetUser607A(static_cast<int>(sigGen[i].Sample()));
 }
 
 void DoSilTest(void)
@@ -657,79 +1670,369 @@ void DoSilTest(void)
 
 void DoAnalogCmdForVelLoop(void)
 {
-	short value = 0;
-	cRTaxis[2].EthercatReadPIVar(6, 0, value);
+	// conditioned at the start of the cycle, see UpdateAnalogInput()
+	double command = analogCommand.GetOutput();
 
-//	std::cout << aiValue << std::endl;
-	if ((value >= -1000) && (value <= 1000))
-		value = 0;
-
-//	std::cout << aiValue << std::endl;
-	double kp = 50000.0;
-	double output = kp * value / 1000.0;
-
-	cRTaxis[0].SetUser60FF(output);
-	cRTaxis[1].SetUser60FF(output);
-//	cRTaxis[2].SetUser60FF(dOutput1);
+	for (int i = 0; i < MAX_AXES; ++i)
+		cRTaxis[i].SetUser60FF(analogScale[i] * command);
 }
 
-void DoVelLoopPidCtrl(void)
+/*
+ * Velocity loop of all axes, torque commands returned in targetCurrent[],
+ * the velocity errors in velocityError[] if not null. velocityOffset[], if
+ * not null, is added to the target velocity of each axis.
+ */
+void VelLoopPid(double* targetCurrent, double* velocityError = nullptr,
+		const double* velocityOffset = nullptr)
 {
 	/*
 	 *  KP = 0.08, KI = 1, TS = 1ms for velocity close loop gains in rad/s units
 	 *  KP = 0.01, KI = 1, TS = 1ms for velocity close loop gains in rpm units
 	 */
 
-	double actVelocity = cRTaxis[0].GetActualVelocity(); // * 60 / 10000.0f;
-	double targetCurrent = pidVelocity(targetVelocity - actVelocity);
-	cRTaxis[0].SetUser6071(targetCurrent);
+	static VelLoopParams params
+	{ 0.0, vel_kp, vel_ki, vel_kd };
+	static unsigned int generation = 0;
+
+	static bool scheduled = false;
+
+	// lock free, keeps the previous set if the Modbus loop is writing right now.
+	bool retune = velLoopParams.TryRead(params, generation);
+	if (retune)
+		velLoopParamsApplied.store(generation, std::memory_order_relaxed);
+
+	// the Modbus gains are back when the schedule is switched off.
+	velGainSchedule.Refresh();
+	const SCHEDULE variable = velGainSchedule.GetVariable();
+	retune = retune || (scheduled && (variable == SCHEDULE::None));
+	scheduled = (variable != SCHEDULE::None);
+
+	double velocity[MAX_AXES], feedback[MAX_AXES], error[MAX_AXES];
+
+	for (int i = 0; i < MAX_AXES; ++i)
+		velocity[i] = velObserver[i].GetVelocity();
+
+	velocityFilter(velocity, feedback);
+
+	for (int i = 0; i < MAX_AXES; ++i)
+	{
+		if (scheduled)
+		{
+			double x =
+					(variable == SCHEDULE::Speed) ? std::fabs(feedback[i]) :
+					(variable == SCHEDULE::Position) ?
+							cRTaxis[i].GetActualPosition() :
+							std::fabs(velObserver[i].GetDisturbance());
+
+			GainSet gains = velGainSchedule.Lookup(x);
+			pidVelocity.Schedule(i, gains.kp, gains.ki, gains.kd, gains.limit);
+		}
+		else if (retune)
+			pidVelocity.Schedule(i, params.kp, params.ki, params.kd, VEL_LOOP_LIMIT);
+	}
+
+	for (int i = 0; i < MAX_AXES; ++i)
+		error[i] = params.targetVelocity - feedback[i]; // * 60 / 10000.0f;
+
+	if (velocityOffset)
+	{
+		for (int i = 0; i < MAX_AXES; ++i)
+			error[i] += velocityOffset[i];
+	}
+
+	pidVelocity(error, targetCurrent);
+
+	if (velocityError)
+		std::copy(error, error + MAX_AXES, velocityError);
+}
+
+void DoVelLoopPidCtrl(void)
+{
+	double targetCurrent[MAX_AXES], torque[MAX_AXES];
+
+	VelLoopPid(targetCurrent);
+	torqueFilter(targetCurrent, torque);
+
+	for (int i = 0; i < MAX_AXES; ++i)
+		cRTaxis[i].SetUser6071(torque[i]);
+}
+
+/*
+ * Velocity loop of all axes, the PID output of TUNE_AXIS replaced by the
+ * relay while the experiment runs, plain velocity loop PID afterwards.
+ */
+void DoVelLoopAutotune(void)
+{
+	double targetCurrent[MAX_AXES], error[MAX_AXES], torque[MAX_AXES];
+
+	VelLoopPid(targetCurrent, error);
+	targetCurrent[TUNE_AXIS] = autotune.Update(error[TUNE_AXIS],
+			targetCurrent[TUNE_AXIS]);
+	torqueFilter(targetCurrent, torque);
+
+	for (int i = 0; i < MAX_AXES; ++i)
+		cRTaxis[i].SetUser6071(torque[i]);
+}
+
+/*
+ * Velocity loop of all axes, IDENT_AXIS swept through the velocity levels
+ * of the identification on top of the Modbus target velocity (keep it 0),
+ * without feedforward, the torque applied is what the model has to learn.
+ */
+void DoFrictionIdent(void)
+{
+	double offset[MAX_AXES] =
+	{ 0.0 };
+	double targetCurrent[MAX_AXES], torque[MAX_AXES];
+
+	offset[IDENT_AXIS] = frictionIdent.GetSetpoint();
+
+	VelLoopPid(targetCurrent, nullptr, offset);
+	torqueFilter(targetCurrent, torque);
+
+	for (int i = 0; i < MAX_AXES; ++i)
+		cRTaxis[i].SetUser6071(torque[i]);
+
+	frictionIdent.Feed(GetAxisState(IDENT_AXIS), torque[IDENT_AXIS]);
+
+	if ((frictionIdent.GetState() == FrictionIdentifier::STATE::Done)
+			&& (frictionFit.load(std::memory_order_relaxed) == FIT::Idle))
+	{
+		frictionSweep.count = frictionIdent.GetLevels(frictionSweep.velocity,
+				frictionSweep.torque);
+
+		OffloadJob job;
+		std::memset(&job, 0, sizeof(job));
+		job.type = FRICTION_FIT_JOB;
+		job.data = &frictionSweep;
+		job.length = sizeof(frictionSweep);
+
+		frictionFit.store(offload.Post(job) ? FIT::Posted : FIT::Local,
+				std::memory_order_release);
+	}
 }
 
 void DoRatchetEffect(void)
 {
-	static double distance = 10000 / 10; // A/B: A -> resolution of feedback, B -> equal parts
-	static PIDController pidPos
-	{ 0.0008, 0.0, 0.0, 10000.0, 2.0, 0.00025 };
-	double actPos = cRTaxis[0].GetActualPosition();
-	double targetPos = round(actPos / distance) * distance;
-	double targetCurrent = pidPos(targetPos - actPos);
+	static EffectChain<TorqueMapEffect> chain
+	{ 2.0,
+	{ &detentMap[0], 1.0 }, SYNC_PERIOD_NS * 1e-9 }; // detents every 10000 / 10 counts, see SILInit()
 
-	cRTaxis[0].SetUser6071(targetCurrent);
+	AxisState state = GetAxisState(0);
+
+	cRTaxis[0].SetUser6071(
+			torqueFilter.Filter(0, chain(state) + feedforward[0](state)));
 }
 
 void DoEdgeEffect(void)
 {
-	double actPos = cRTaxis[0].GetActualPosition();
-	static PIDController pidPos
-	{ 0.01, 0.0, 0.0, 10000.0, 2.0, 0.00025 };
-	double L = initPos[0] - 2500, R = initPos[0] + 2500;
-
-//	if (act_pos < R && act_pos > L)
-//		cRTaxis[0].SetUser6071(0);
-//	else
-//	{
-//		if (act_pos < L)
-//			cRTaxis[0].SetUser6071(pid_pos(L - act_pos));
-//		if (act_pos > R)
-//			cRTaxis[0].SetUser6071(pid_pos(R - act_pos));
-//	}
+	static EffectChain<FixtureEffect> chain
+	{ 2.0,
+	{ &edgeFixtures[0] }, SYNC_PERIOD_NS * 1e-9 };	// walls at initPos +/- 2500, see PublishEdgeFixtures()
 
-	double output = (actPos < L) ? (L - actPos) :
-					(actPos > R) ? (R - actPos) : 0.0;
+	AxisState state = GetAxisState(0);
 
-	cRTaxis[0].SetUser6071(pidPos(output));
+	cRTaxis[0].SetUser6071(
+			torqueFilter.Filter(0, chain(state) + feedforward[0](state)));
 }
 
 void DoDampEffect(void)
 {
-	double kp = 0.0001;
+	static EffectChain<DampEffect> chain
+	{ std::numeric_limits<double>::max(),
+	{ 0.0001 }, SYNC_PERIOD_NS * 1e-9 };
 
-	cRTaxis[0].SetUser6071(-kp*cRTaxis[0].GetActualVelocity());
+	AxisState state = GetAxisState(0);
+
+	cRTaxis[0].SetUser6071(
+			torqueFilter.Filter(0, chain(state) + feedforward[0](state)));
 }
 
 void DoSmoothEffect(void)
 {
-	static PIDController pid {0.0001,0,0,1000,0.05,0.00025};
+	static EffectChain<SmoothEffect> chain
+	{ 0.05,
+	{ 0.0001, 1000.0, 0.05 }, SYNC_PERIOD_NS * 1e-9 };
+
+	AxisState state = GetAxisState(0);
+
+	cRTaxis[0].SetUser6071(
+			torqueFilter.Filter(0, chain(state) + feedforward[0](state)));
+}
+
+void DoEffectPipeline(void)
+{
+	double effect[MAX_AXES], torque[MAX_AXES];
+
+	for (int i = 0; i < MAX_AXES; ++i)
+	{
+		AxisState state = GetAxisState(i);
+		effect[i] = hapticPipeline[i](state) + feedforward[i](state);
+	}
+
+	torqueFilter(effect, torque);
+
+	for (int i = 0; i < MAX_AXES; ++i)
+		cRTaxis[i].SetUser6071(torque[i]);
+}
+
+void DoStreamForPosLoop(void)
+{
+	double position[MAX_AXES];
+
+	// idle / stopped -> the drives keep the last user command.
+	if (posStream.Sample(position))
+	{
+		for (int i = 0; i < MAX_AXES; ++i)
+			cRTaxis[i].SetUser607A(static_cast<int>(std::lround(position[i])));
+	}
+}
+
+void DoFreqResponse(void)
+{
+	double excitation = fra.Excitation();
+	double command = 0.0;
+
+	if (modeManager.GetMotionMode() == MOTIONMODE::TMode)
+	{
+		// closed velocity loop, the chirp is added to its torque output. The
+		// torque filters are left out, the plant is measured to design them.
+		double targetCurrent[MAX_AXES];
+
+		VelLoopPid(targetCurrent);
+		targetCurrent[FRA_AXIS] += excitation;
+		command = targetCurrent[FRA_AXIS];
+
+		for (int i = 0; i < MAX_AXES; ++i)
+			cRTaxis[i].SetUser6071(targetCurrent[i]);
+	}
+	else
+	{
+		static VelLoopParams params
+		{ 0.0, vel_kp, vel_ki, vel_kd };
+		static unsigned int generation = 0;
+
+		velLoopParams.TryRead(params, generation);
+
+		command = params.targetVelocity + excitation;
+		cRTaxis[FRA_AXIS].SetUser60FF(command);
+	}
+
+	fra.Feed(command, cRTaxis[FRA_AXIS].GetActualVelocity(),
+			cRTaxis[FRA_AXIS].GetActualPosition());
+}
+
+void UpdateObservers(void)
+{
+	for (int i = 0; i < MAX_AXES; ++i)
+		velObserver[i].Update(cRTaxis[i].GetActualPosition(), cRTaxis[i].GetActualTorque());
+}
+
+/*
+ * The analog input is read once per cycle, whatever the number of axes
+ * it drives, and kept conditioned so it is up to date on a function switch.
+ */
+void UpdateAnalogInput(void)
+{
+	short value = 0;
+	cRTaxis[ANALOG_AXIS].EthercatReadPIVar(ANALOG_PI_OFFSET, 0, value);
+
+	analogCommand.Update(value);
+}
+
+void RecordScope(void)
+{
+	if (!scope.IsRecording())
+		return;
+
+	CMMCRTSingleAxis& axis = cRTaxis[SCOPE_AXIS];
+	scope.Feed(axis.GetActualPosition(), axis.GetActualVelocity(),
+			axis.GetActualTorque(), axis.GetDigInputs());
+}
+
+void RunSilFunction(void)
+{
+	modeManager.Run();
+}
+
+void DispatchOffloadResults(void)
+{
+	offload.Dispatch();
+}
+
+/*
+ * Offload worker: fit of the copied sweep, never of frictionIdent itself.
+ * value[] -> coulomb, viscous, stribeck, stribeckVelocity, offset, rms,
+ * status 1 -> too few levels.
+ */
+void FrictionFitWork(const OffloadJob& job, OffloadResult& result)
+{
+	const FrictionSweep* sweep = static_cast<const FrictionSweep*>(job.data);
+	FeedforwardParams model;
+	double rms = 0.0;
+
+	if (!FrictionIdentifier::FitLevels(sweep->velocity, sweep->torque,
+			sweep->count, model, &rms))
+	{
+		result.status = 1;
+		return;
+	}
+
+	result.value[0] = model.coulomb;
+	result.value[1] = model.viscous;
+	result.value[2] = model.stribeck;
+	result.value[3] = model.stribeckVelocity;
+	result.value[4] = model.offset;
+	result.value[5] = rms;
+}
+
+/*
+ * RT, from DispatchOffloadResults(): hand the fit to the Modbus loop.
+ */
+void FrictionFitDone(const OffloadResult& result)
+{
+	frictionFitResult = result;
+	frictionFit.store(FIT::Ready, std::memory_order_release);
+}
+
+/*
+ * Supervision at 1/10 of the sync rate, axes in error stop for Modbus.
+ */
+void MonitorAxes(void)
+{
+	unsigned int mask = 0;
+
+	for (int i = 0; i < MAX_AXES; ++i)
+	{
+		if (cRTaxis[i].ReadStatus() & NC_AXIS_ERROR_STOP_MASK)
+			mask |= (1u << i);
+	}
+
+	axisFaultMask.store(mask, std::memory_order_relaxed);
+}
+
+AxisState GetAxisState(int axis)
+{
+	return
+	{	cRTaxis[axis].GetActualPosition(), velObserver[axis].GetVelocity()};
+}
+
+/*
+ * Watchdog fallbacks, as cheap as possible.
+ */
+void DoHoldCommand(void)
+{
+	// nothing written, the drives keep the last user command.
+}
+
+void DoStopVelocity(void)
+{
+	for (int i = 0; i < MAX_AXES; ++i)
+		cRTaxis[i].SetUser60FF(0);
+}
 
-	cRTaxis[0].SetUser6071(pid(cRTaxis[0].GetActualVelocity()));
+void DoDampAllAxes(void)
+{
+	for (int i = 0; i < MAX_AXES; ++i)
+		cRTaxis[i].SetUser6071(-0.0001 * cRTaxis[i].GetActualVelocity());
 }
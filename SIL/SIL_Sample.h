@@ -39,6 +39,14 @@ SILCallBackFun(void);
  ============================================================================
  */
 #define 	MAX_AXES				1		// number of Physical axes in the system
+#define 	MAIN_LOOP_PERIOD_US		100000	// Modbus polling period, 100ms
+#define 	SYNC_PERIOD_NS			250000	// SYNC timer period, deadline of the RT callback
+#define 	OVERRUN_ESCALATE		10		// consecutive overruns before the watchdog falls back
+#define 	RT_CPU_MASK				0x2		// CPUs of the SYNC thread, CPU0 left to Linux housekeeping
+#define 	HOUSEKEEPING_CPU_MASK	0x1		// CPUs of main loop and the other non-RT threads
+#define 	OFFLOAD_CPU_MASK		HOUSEKEEPING_CPU_MASK	// CPUs of the offload workers
+#define 	OFFLOAD_PRIORITY		0		// SCHED_OTHER, must not starve the housekeeping CPUs
+#define 	OBSERVER_TORQUE_GAIN	0.0		// counts/s^2 per torque unit, 0 -> no load estimate
 /*
  ============================================================================
  Application global variables
@@ -50,6 +58,33 @@ double targetVelocity = 0.0;
 double prev_target_velocity = 0.0;
 double vel_ki = 0.0;
 double vel_kp = 0.0001;
+double prev_vel_ki = vel_ki;
+double prev_vel_kp = vel_kp;
+double vel_kd = 0.0;			// set by the autotune only, no register
+double prev_vel_kd = vel_kd;
+bool fraStart = false;
+bool prev_fra_start = false;
+unsigned short effectMask = 0;
+unsigned short prev_effect_mask = 0;
+int silFuncRequest = 0;
+int prev_sil_func_request = 0;
+bool scopeArm = false;
+bool prev_scope_arm = false;
+bool scopeArmPending = false;
+unsigned short scopeTrigger = 0;
+short scopeLevel = 0;
+unsigned short scopeMask = 0;
+short filterSetting[5] =
+{ 0 };	// Modbus registers 11..15, see ConfigureFilters()
+short prev_filter_setting[5] =
+{ 0 };
+bool streamStart = false;
+bool prev_stream_start = false;
+short tuneRule = 0;			// TUNING of the next autotune
+unsigned short feedforwardMask = 0;
+unsigned short prev_feedforward_mask = 0;
+short scheduleVariable = 0;		// SCHEDULE of the velocity loop gains
+short prev_schedule_variable = 0;
 /*
  ============================================================================
  Global structures for Elmo's Function Blocks
@@ -0,0 +1,87 @@
+/*
+ * analog_input.cpp
+ *
+ * Created on: Oct 19, 2026
+ * Author: RockyLiu
+ */
+
+#include "analog_input.h"
+#include <algorithm>
+#include <cmath>
+
+AnalogConditioner::AnalogConditioner(double ts) :
+		_ts(ts)
+{
+	Configure(AnalogParams());
+}
+
+void AnalogConditioner::Configure(const AnalogParams& params)
+{
+	_params = params;
+	_params.average = std::min(std::max(params.average, 1), MAX_AVERAGE);
+	if (!(_params.fullScale > 0.0))
+		_params.fullScale = 32767.0;
+	_params.deadband = std::min(std::max(params.deadband, 0.0),
+			0.5 * _params.fullScale);
+	_params.expo = std::min(std::max(params.expo, 0.0), 1.0);
+
+	for (int i = 0; i < MAX_AVERAGE; ++i)
+		_history[i] = 0;
+	_head = 0;
+	_sum = 0;
+
+	// the sum of the average is looked up directly, no division per cycle
+	_curveScale = CURVE_SIZE / (_params.fullScale * _params.average);
+
+	for (int i = 0; i <= CURVE_SIZE; ++i)
+	{
+		double v = Knee(static_cast<double>(i) / CURVE_SIZE);
+		_curve[i] = static_cast<float>(
+				(1.0 - _params.expo) * v + _params.expo * v * v * v);
+	}
+
+	_rateStep = (_params.rateLimit > 0.0) ? _params.rateLimit * _ts : 0.0;
+	_alpha = (_params.cutoff > 0.0) ?
+			1.0 - std::exp(-6.2831853071795862 * _params.cutoff * _ts) : 1.0;
+
+	_limited = 0.0;
+	_output = 0.0;
+}
+
+double AnalogConditioner::Knee(double u) const
+{
+	const double d = _params.deadband / _params.fullScale;
+	const double w = 0.5 * d;	// half width of the knee
+
+	if (u >= d + w)
+		return (u - d) / (1.0 - d);
+	if (u <= d - w)
+		return 0.0;
+
+	// same value and slope as the linear part at d + w
+	return (u - d + w) * (u - d + w) / (4.0 * w * (1.0 - d));
+}
+
+double AnalogConditioner::Update(short raw)
+{
+	_sum += raw - _history[_head];
+	_history[_head] = raw;
+	if (++_head >= _params.average)
+		_head = 0;
+
+	double position = std::min(std::fabs(_sum * _curveScale),
+			static_cast<double>(CURVE_SIZE));
+	int index = std::min(static_cast<int>(position), CURVE_SIZE - 1);
+	double frac = position - index;
+	double curve = _curve[index] + frac * (_curve[index + 1] - _curve[index]);
+	double target = (_sum < 0) ? -curve : curve;
+
+	if (_rateStep > 0.0)
+		_limited += std::min(std::max(target - _limited, -_rateStep), _rateStep);
+	else
+		_limited = target;
+
+	_output += _alpha * (_limited - _output);
+
+	return _output;
+}
@@ -0,0 +1,88 @@
+/*
+ * analog_input.h
+ *
+ * Created on: Oct 19, 2026
+ * Author: RockyLiu
+ *
+ * Conditioning of one analog input used as a command, fed once per sync
+ * cycle with the raw value read from the drive:
+ *
+ * 	moving average -> deadband + expo curve -> rate limit -> 1st order low-pass
+ *
+ * The output is normalized to [-1, 1] of the full scale, each consumer
+ * applies its own scale, so one conditioned signal can drive many axes.
+ *
+ * The deadband has a quadratic knee, the output leaves 0 with the slope of
+ * the linear part instead of jumping to the edge of the band. Deadband and
+ * expo are sampled into one table over |input| on the non-RT side, the RT
+ * side only does one interpolated lookup whatever the curve.
+ *
+ * Configure() before the sync timer is created, like TorqueMap the table
+ * must not be rebuilt while Update() runs.
+ */
+
+#pragma once
+
+struct AnalogParams
+{
+	int average = 4;				// samples of the moving average, 1 -> off
+	double deadband = 1000.0;		// raw unit, around 0
+	double fullScale = 32767.0;		// raw unit giving an output of 1
+	double expo = 0.0;				// 0 -> linear, 1 -> cubic
+	double rateLimit = 0.0;			// full scale per s, 0 -> off
+	double cutoff = 0.0;			// Hz, 0 -> off
+};
+
+class AnalogConditioner
+{
+public:
+	static constexpr int MAX_AVERAGE = 16;
+	static constexpr int CURVE_SIZE = 256;
+
+	explicit
+	AnalogConditioner(double ts = 0.00025);
+	~AnalogConditioner() = default;
+
+	AnalogConditioner(const AnalogConditioner&) = delete;
+	AnalogConditioner&
+	operator=(const AnalogConditioner&) = delete;
+
+	/*
+	 * Non-RT: build the curve and clear the states.
+	 */
+	void
+	Configure(const AnalogParams& params);
+
+	/*
+	 * RT: condition the raw value of this cycle, returns the output in [-1, 1].
+	 */
+	double
+	Update(short raw);
+
+	double
+	GetOutput(void) const
+	{
+		return _output;
+	}
+
+private:
+	double
+	Knee(double u) const;
+
+	double _ts;
+	AnalogParams _params;
+
+	// moving average
+	int _history[MAX_AVERAGE];
+	int _head;
+	int _sum;
+
+	// deadband + expo over |input| / fullScale in [0, 1]
+	double _curveScale;		// CURVE_SIZE / (fullScale * average)
+	float _curve[CURVE_SIZE + 1];
+
+	double _rateStep;		// per cycle, 0 -> off
+	double _alpha;			// low-pass, 1 -> off
+	double _limited;
+	double _output;
+};
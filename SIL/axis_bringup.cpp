@@ -0,0 +1,181 @@
+/*
+ * axis_bringup.cpp
+ *
+ * Created on: Oct 19, 2026
+ * Author: RockyLiu
+ */
+
+#include "axis_bringup.h"
+#include <iostream>
+#include <syslog.h>
+#include <time.h>
+
+AxisBringUp::AxisBringUp(CMMCRTSingleAxis* axes, int axisCount) :
+		_axes(axes), _axisCount(axisCount), _results(axisCount), _since(
+				axisCount), _start(0), _elapsed(0.0)
+{
+}
+
+int64_t AxisBringUp::Now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+void AxisBringUp::Fail(int i, const char* error, int64_t now)
+{
+	_results[i].failed = true;
+	_results[i].error = error;
+	_results[i].elapsed = (now - _start) * 1e-6;
+}
+
+void AxisBringUp::Step(int i, MOTIONMODE mode, const BringUpParams& params,
+		int64_t now)
+{
+	Result& result = _results[i];
+	CMMCRTSingleAxis& axis = _axes[i];
+	const int64_t inStep = now - _since[i];
+
+	switch (result.step)
+	{
+	case STEP::OpMode:
+		if (ModeManager::CompleteOpMode(axis, mode))
+		{
+			result.step = STEP::Settle;
+			_since[i] = now;
+		}
+		else if (inStep > params.opModeTimeout * 1000000LL)
+			Fail(i, "op-mode timeout", now);
+		break;
+
+	case STEP::Settle:
+		// let the drive finish the mode change before the power-on.
+		if (inStep >= params.settle * 1000000LL)
+		{
+			axis.PowerOn();
+			result.step = STEP::PowerOn;
+			_since[i] = now;
+		}
+		break;
+
+	case STEP::PowerOn:
+	{
+		const unsigned int status = axis.ReadStatus();
+
+		if (status & NC_AXIS_ERROR_STOP_MASK)
+			Fail(i, "error stop", now);
+		else if (status & NC_AXIS_STAND_STILL_MASK)
+		{
+			result.step = STEP::Ready;
+			result.elapsed = (now - _start) * 1e-6;
+		}
+		else if (inStep > params.powerOnTimeout * 1000000LL)
+			Fail(i, "power-on timeout", now);
+		break;
+	}
+
+	case STEP::Ready:
+		break;
+	}
+}
+
+int AxisBringUp::Run(MOTIONMODE mode, const BringUpParams& params)
+{
+	_start = Now();
+
+	// all requests out first, the drives work on them in parallel.
+	for (int i = 0; i < _axisCount; ++i)
+	{
+		_results[i] = Result
+		{ STEP::OpMode, false, 0.0, nullptr, 0 };
+		_since[i] = _start;
+
+		try
+		{
+			ModeManager::RequestOpMode(_axes[i], mode);
+		} catch (CMMCException& e)
+		{
+			_results[i].code = e.error();
+			Fail(i, "MMC exception", Now());
+		}
+	}
+
+	int pending;
+	do
+	{
+		pending = 0;
+		const int64_t now = Now();
+
+		for (int i = 0; i < _axisCount; ++i)
+		{
+			Result& result = _results[i];
+			if (result.failed || (result.step == STEP::Ready))
+				continue;
+
+			try
+			{
+				Step(i, mode, params, now);
+			} catch (CMMCException& e)
+			{
+				result.code = e.error();
+				Fail(i, "MMC exception", now);
+			}
+
+			if (!result.failed && (result.step != STEP::Ready))
+				++pending;
+		}
+
+		if (pending)
+			usleep(params.poll * 1000);
+	} while (pending);
+
+	_elapsed = (Now() - _start) * 1e-6;
+
+	int failed = 0;
+	for (int i = 0; i < _axisCount; ++i)
+	{
+		if (_results[i].failed)
+			++failed;
+	}
+
+	return failed;
+}
+
+void AxisBringUp::Report(void) const
+{
+	for (int i = 0; i < _axisCount; ++i)
+	{
+		const Result& result = _results[i];
+
+		if (result.failed)
+		{
+			syslog(LOG_ERR, "axis %d: %s in step %s after %.1f ms, error %d\n", i,
+					result.error, GetName(result.step), result.elapsed, result.code);
+			std::cerr << "axis " << i << ": " << result.error << " in step "
+					<< GetName(result.step) << " after " << result.elapsed
+					<< " ms, error " << result.code << "\n";
+		}
+		else
+			syslog(LOG_INFO, "axis %d: ready after %.1f ms\n", i, result.elapsed);
+	}
+
+	syslog(LOG_INFO, "%d axes brought up in %.1f ms\n", _axisCount, _elapsed);
+}
+
+const char* AxisBringUp::GetName(STEP step)
+{
+	switch (step)
+	{
+	case STEP::OpMode:
+		return "op-mode";
+	case STEP::Settle:
+		return "settle";
+	case STEP::PowerOn:
+		return "power-on";
+	case STEP::Ready:
+		return "ready";
+	}
+
+	return "unknown";
+}
@@ -0,0 +1,106 @@
+/*
+ * axis_bringup.h
+ *
+ * Created on: Oct 19, 2026
+ * Author: RockyLiu
+ *
+ * Start-up of all axes together: op-mode, command source and power-on.
+ *
+ * Run() sends the op-mode request to every axis first, then polls all of
+ * them in one loop. Each axis moves on by itself through
+ * 	OpMode -> Settle -> PowerOn -> Ready
+ * as soon as its drive reports the step done, so start-up takes as long as
+ * the slowest axis instead of the sum of all of them. An axis that misses
+ * the timeout of a step, drops to error stop or throws is left where it is
+ * and reported, the others carry on.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "mode_manager.h"
+
+struct BringUpParams
+{
+	int opModeTimeout = 1000;	// ms, op-mode request -> reported by the drive
+	int powerOnTimeout = 5000;	// ms, power-on -> stand still
+	int settle = 1;				// ms, op-mode reported -> power-on
+	int poll = 1;				// ms
+};
+
+class AxisBringUp
+{
+public:
+	enum class STEP
+	{
+		OpMode, Settle, PowerOn, Ready,
+	};
+
+	struct Result
+	{
+		STEP step;			// reached, or the one that failed
+		bool failed;
+		double elapsed;		// ms, from the start of Run() to ready / failure
+		const char* error;	// nullptr unless failed
+		int code;			// MMC error of an exception, 0 otherwise
+	};
+
+	AxisBringUp(CMMCRTSingleAxis* axes, int axisCount);
+	~AxisBringUp() = default;
+
+	AxisBringUp(const AxisBringUp&) = delete;
+	AxisBringUp&
+	operator=(const AxisBringUp&) = delete;
+
+	/*
+	 * Non-RT, before the sync timer is created: bring all axes up in 'mode',
+	 * user command source preloaded from the feedback, powered on and
+	 * standing still. Blocks until every axis is ready or failed, returns
+	 * the number of failed axes.
+	 */
+	int
+	Run(MOTIONMODE mode, const BringUpParams& params = BringUpParams());
+
+	const Result&
+	GetResult(int axis) const
+	{
+		return _results[axis];
+	}
+
+	/*
+	 * ms, the whole last Run().
+	 */
+	double
+	GetElapsed(void) const
+	{
+		return _elapsed;
+	}
+
+	/*
+	 * Non-RT: one line per axis to syslog, the failed ones also to stderr.
+	 */
+	void
+	Report(void) const;
+
+	static const char*
+	GetName(STEP step);
+
+private:
+	static int64_t
+	Now(void);
+
+	void
+	Step(int i, MOTIONMODE mode, const BringUpParams& params, int64_t now);
+
+	void
+	Fail(int i, const char* error, int64_t now);
+
+	CMMCRTSingleAxis* _axes;
+	int _axisCount;
+
+	std::vector<Result> _results;
+	std::vector<int64_t> _since;	// ns, start of the current step
+	int64_t _start;
+	double _elapsed;
+};
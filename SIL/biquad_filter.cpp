@@ -0,0 +1,92 @@
+/*
+ * biquad_filter.cpp
+ *
+ * Created on: Oct 19, 2026
+ * Author: RockyLiu
+ */
+
+#include "biquad_filter.h"
+#include <cmath>
+
+namespace
+{
+	constexpr double PI = 3.1415926535897931;
+
+	/*
+	 * Pre-warped bilinear transform constant, K = tan(w T / 2), 0 when the
+	 * frequency is not usable.
+	 */
+	double
+	Prewarp(double frequency, double ts)
+	{
+		if (!(frequency > 0.0) || !(ts > 0.0))
+			return 0.0;
+
+		if (frequency > 0.45 / ts)
+			frequency = 0.45 / ts;
+
+		return std::tan(PI * frequency * ts);
+	}
+
+	BiquadCoeffs
+	Normalize(double b0, double b1, double b2, double a0, double a1, double a2)
+	{
+		return
+		{	b0 / a0, b1 / a0, b2 / a0, a1 / a0, a2 / a0};
+	}
+}
+
+BiquadCoeffs DesignBiquad(const BiquadSection& section, double ts)
+{
+	const BiquadCoeffs bypass =
+	{ 1.0, 0.0, 0.0, 0.0, 0.0 };
+
+	const double k = Prewarp(section.frequency, ts);
+	const double q = (section.q > 0.0) ? section.q : 0.707;
+
+	if (k <= 0.0)
+		return bypass;
+
+	// 2nd order sections, analog prototypes normalized to the section frequency
+	const double kk = k * k;
+	const double a0 = 1.0 + k / q + kk;
+	const double a1 = 2.0 * (kk - 1.0);
+	const double a2 = 1.0 - k / q + kk;
+
+	switch (section.type)
+	{
+	case FILTER::LowPass:
+		// 1 / (s^2 + s / q + 1)
+		return Normalize(kk, 2.0 * kk, kk, a0, a1, a2);
+
+	case FILTER::Notch:
+	case FILTER::BandStop:
+	{
+		// (s^2 + g s / q + 1) / (s^2 + s / q + 1), g = gain at the frequency
+		const double g =
+				(section.type == FILTER::Notch) ?
+						std::pow(10.0, -std::fabs(section.depth) / 20.0) : 0.0;
+
+		return Normalize(1.0 + g * k / q + kk, a1, 1.0 - g * k / q + kk, a0, a1,
+				a2);
+	}
+
+	case FILTER::LeadLag:
+	{
+		// (s / wz + 1) / (s / wp + 1), each corner pre-warped
+		const double kp = Prewarp(section.poleFrequency, ts);
+		if (kp <= 0.0)
+			return bypass;
+
+		const double cz = 1.0 / k;
+		const double cp = 1.0 / kp;
+
+		return Normalize(1.0 + cz, 1.0 - cz, 0.0, 1.0 + cp, 1.0 - cp, 0.0);
+	}
+
+	case FILTER::None:
+		break;
+	}
+
+	return bypass;
+}
@@ -0,0 +1,255 @@
+/*
+ * biquad_filter.h
+ *
+ * Created on: Oct 19, 2026
+ * Author: RockyLiu
+ *
+ * Bank of N cascades of S biquad sections, one cascade per axis, for the
+ * torque commands and the velocity feedback.
+ *
+ * Sections are designed on the non-RT side from frequency / Q / depth
+ * (bilinear transform, pre-warped at the section frequency) by DesignBiquad().
+ * The RT side runs every section in transposed direct form II, with the
+ * coefficients and states in structure-of-arrays form like PIDBank, so the
+ * loop over the axes is turned into SIMD instructions.
+ *
+ * Coefficient changes: SetSection() only edits a non-RT copy, Apply()
+ * publishes the whole bank through a ParamBlock and the RT side switches to
+ * it between two samples. A section whose coefficients changed restarts from
+ * the steady state of its last input, so enabling or retuning a filter on a
+ * running command does not kick the axis.
+ *
+ * Note: NEON on the ARMv7 Maestro only vectorizes float, use
+ * BiquadBank<N, S, float> there when the precision is good enough.
+ */
+
+#pragma once
+
+#include "param_block.h"
+
+enum class FILTER
+{
+	None, LowPass, Notch, BandStop, LeadLag,
+};
+
+/**
+ * One section, unused fields are ignored.
+ * 	LowPass		2nd order, 'frequency' and 'q'
+ * 	Notch		attenuation of 'depth' dB at 'frequency', width from 'q'
+ * 	BandStop	full notch at 'frequency', width from 'q'
+ * 	LeadLag		1st order, zero at 'frequency', pole at 'poleFrequency'
+ */
+struct BiquadSection
+{
+	FILTER type = FILTER::None;
+	double frequency = 100.0;		// Hz
+	double q = 0.707;
+	double depth = 20.0;			// dB, Notch
+	double poleFrequency = 200.0;	// Hz, LeadLag
+};
+
+/**
+ * Normalized coefficients, H(z) = (b0 + b1 z^-1 + b2 z^-2) / (1 + a1 z^-1 + a2 z^-2).
+ */
+struct BiquadCoeffs
+{
+	double b0;
+	double b1;
+	double b2;
+	double a1;
+	double a2;
+};
+
+/*
+ * Non-RT: coefficients of one section, pass-through for FILTER::None and for
+ * frequencies out of (0, Nyquist), which are clipped to 0.45 / ts first.
+ */
+BiquadCoeffs
+DesignBiquad(const BiquadSection& section, double ts);
+
+template<int N, int S, typename Scalar = double>
+class BiquadBank
+{
+	static_assert(N >= 1, "BiquadBank needs at least 1 axis!");
+	static_assert(S >= 1, "BiquadBank needs at least 1 section!");
+
+	struct Coefficients
+	{
+		Scalar b0[S][N];
+		Scalar b1[S][N];
+		Scalar b2[S][N];
+		Scalar a1[S][N];
+		Scalar a2[S][N];
+	};
+
+public:
+	explicit
+	BiquadBank(double ts = 0.00025) :
+			_ts(ts), _design(Bypass()), _published(_design), _active(_design), _generation(
+					_published.Generation())
+	{
+		Reset();
+	}
+	~BiquadBank() = default;
+
+	BiquadBank(const BiquadBank&) = delete;
+	BiquadBank&
+	operator=(const BiquadBank&) = delete;
+
+	/*
+	 * Non-RT: design section 's' of axis 'i', takes effect on Apply().
+	 */
+	void
+	SetSection(int i, int s, const BiquadSection& section)
+	{
+		BiquadCoeffs c = DesignBiquad(section, _ts);
+
+		_design.b0[s][i] = static_cast<Scalar>(c.b0);
+		_design.b1[s][i] = static_cast<Scalar>(c.b1);
+		_design.b2[s][i] = static_cast<Scalar>(c.b2);
+		_design.a1[s][i] = static_cast<Scalar>(c.a1);
+		_design.a2[s][i] = static_cast<Scalar>(c.a2);
+	}
+
+	/*
+	 * Non-RT: publish all sections, the RT side picks them up on its next
+	 * sample. Returns the generation of the published set.
+	 */
+	unsigned int
+	Apply(void)
+	{
+		return _published.Publish(_design);
+	}
+
+	/*
+	 * RT: clear the filter states.
+	 */
+	void
+	Reset(void)
+	{
+		for (int s = 0; s < S; ++s)
+			for (int i = 0; i < N; ++i)
+			{
+				_z1[s][i] = 0;
+				_z2[s][i] = 0;
+				_input[s][i] = 0;
+			}
+	}
+
+	/*
+	 * RT: filter all axes in one pass, in[] and out[] hold N values and
+	 * must not overlap.
+	 */
+	void
+	operator()(const Scalar* __restrict in, Scalar* __restrict out)
+	{
+		Refresh();
+
+		for (int i = 0; i < N; ++i)
+			out[i] = in[i];
+
+		for (int s = 0; s < S; ++s)
+		{
+#if defined(__GNUC__)
+#pragma GCC ivdep
+#endif
+			for (int i = 0; i < N; ++i)
+			{
+				const Scalar x = out[i];
+				const Scalar y = _active.b0[s][i] * x + _z1[s][i];
+
+				_z1[s][i] = _active.b1[s][i] * x - _active.a1[s][i] * y + _z2[s][i];
+				_z2[s][i] = _active.b2[s][i] * x - _active.a2[s][i] * y;
+				_input[s][i] = x;
+				out[i] = y;
+			}
+		}
+	}
+
+	/*
+	 * RT: filter axis 'i' only, for the functions commanding a single axis.
+	 */
+	Scalar
+	Filter(int i, Scalar x)
+	{
+		Refresh();
+
+		for (int s = 0; s < S; ++s)
+		{
+			const Scalar y = _active.b0[s][i] * x + _z1[s][i];
+
+			_z1[s][i] = _active.b1[s][i] * x - _active.a1[s][i] * y + _z2[s][i];
+			_z2[s][i] = _active.b2[s][i] * x - _active.a2[s][i] * y;
+			_input[s][i] = x;
+			x = y;
+		}
+
+		return x;
+	}
+
+private:
+	static Coefficients
+	Bypass(void)
+	{
+		Coefficients c;
+
+		for (int s = 0; s < S; ++s)
+			for (int i = 0; i < N; ++i)
+			{
+				c.b0[s][i] = 1;
+				c.b1[s][i] = 0;
+				c.b2[s][i] = 0;
+				c.a1[s][i] = 0;
+				c.a2[s][i] = 0;
+			}
+
+		return c;
+	}
+
+	/*
+	 * RT: switch to a newly published set, only when there is one.
+	 */
+	void
+	Refresh(void)
+	{
+		if (!_published.TryRead(_pending, _generation))
+			return;
+
+		for (int s = 0; s < S; ++s)
+			for (int i = 0; i < N; ++i)
+			{
+				const Scalar b0 = _pending.b0[s][i];
+				const Scalar b1 = _pending.b1[s][i];
+				const Scalar b2 = _pending.b2[s][i];
+				const Scalar a1 = _pending.a1[s][i];
+				const Scalar a2 = _pending.a2[s][i];
+
+				if ((b0 == _active.b0[s][i]) && (b1 == _active.b1[s][i])
+						&& (b2 == _active.b2[s][i]) && (a1 == _active.a1[s][i])
+						&& (a2 == _active.a2[s][i]))
+					continue;
+
+				// steady state of the new section for its last input
+				const Scalar x = _input[s][i];
+				const Scalar y = x * (b0 + b1 + b2) / (1 + a1 + a2);
+
+				_z1[s][i] = y - b0 * x;
+				_z2[s][i] = b2 * x - a2 * y;
+			}
+
+		_active = _pending;
+	}
+
+	double _ts;
+
+	Coefficients _design;				// non-RT copy
+	ParamBlock<Coefficients> _published;
+	alignas(64) Coefficients _active;	// RT copy
+	Coefficients _pending;
+	unsigned int _generation;
+
+	// states, s[n-1] / s[n-2] and last input per section and axis
+	alignas(64) Scalar _z1[S][N];
+	alignas(64) Scalar _z2[S][N];
+	alignas(64) Scalar _input[S][N];
+};
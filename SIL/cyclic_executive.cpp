@@ -0,0 +1,211 @@
+/*
+ * cyclic_executive.cpp
+ *
+ * Created on: Oct 19, 2026
+ * Author: RockyLiu
+ */
+
+#include "cyclic_executive.h"
+#include <iomanip>
+#include <iostream>
+
+namespace
+{
+	int
+	Gcd(int a, int b)
+	{
+		while (b)
+		{
+			int r = a % b;
+			a = b;
+			b = r;
+		}
+		return a;
+	}
+}
+
+CyclicExecutive::CyclicExecutive(const Task* table, int taskCount) :
+		_table(table), _taskCount(taskCount), _slotCount(1), _slot(0), _cycles(0), _loadTotal(
+				0), _loadMax(0)
+{
+	for (int i = 0; i < MAX_TASKS; ++i)
+	{
+		_phase[i] = 0;
+		_stats[i].runs.store(0, std::memory_order_relaxed);
+		_stats[i].total.store(0, std::memory_order_relaxed);
+		_stats[i].max.store(0, std::memory_order_relaxed);
+	}
+
+	for (int s = 0; s < MAX_SLOTS; ++s)
+	{
+		_slotTasks[s] = 0;
+		_slotMax[s].store(0, std::memory_order_relaxed);
+	}
+}
+
+bool CyclicExecutive::Init(void)
+{
+	if ((_taskCount < 1) || (_taskCount > MAX_TASKS))
+	{
+		std::cerr << "cyclic executive: 1 to " << MAX_TASKS << " tasks\n";
+		return false;
+	}
+
+	// hyperperiod
+	int slots = 1;
+	for (int i = 0; i < _taskCount; ++i)
+	{
+		const Task& task = _table[i];
+
+		if ((task.divisor < 1) || (task.phase >= task.divisor)
+				|| ((task.phase < 0) && (task.phase != AUTO_PHASE)))
+		{
+			std::cerr << "cyclic executive: bad rate / phase of " << task.name
+					<< "\n";
+			return false;
+		}
+
+		slots = slots / Gcd(slots, task.divisor) * task.divisor;
+		if (slots > MAX_SLOTS)
+		{
+			std::cerr << "cyclic executive: hyperperiod longer than " << MAX_SLOTS
+					<< " cycles\n";
+			return false;
+		}
+	}
+	_slotCount = slots;
+
+	// expected load per cycle, the fixed tasks first
+	double load[MAX_SLOTS] =
+	{ 0.0 };
+	bool placed[MAX_TASKS] =
+	{ false };
+
+	for (int i = 0; i < _taskCount; ++i)
+	{
+		if (_table[i].phase == AUTO_PHASE)
+			continue;
+
+		_phase[i] = _table[i].phase;
+		placed[i] = true;
+		for (int s = _phase[i]; s < _slotCount; s += _table[i].divisor)
+			load[s] += _table[i].budget;
+	}
+
+	// then the others, largest budget first, each in its least loaded phase
+	for (;;)
+	{
+		int next = -1;
+		for (int i = 0; i < _taskCount; ++i)
+		{
+			if (!placed[i] && ((next < 0) || (_table[i].budget > _table[next].budget)))
+				next = i;
+		}
+		if (next < 0)
+			break;
+
+		const Task& task = _table[next];
+		int best = 0;
+		double bestPeak = 0.0;
+
+		for (int p = 0; p < task.divisor; ++p)
+		{
+			double peak = 0.0;
+			for (int s = p; s < _slotCount; s += task.divisor)
+				peak = (load[s] > peak) ? load[s] : peak;
+
+			if ((p == 0) || (peak < bestPeak))
+			{
+				best = p;
+				bestPeak = peak;
+			}
+		}
+
+		_phase[next] = best;
+		placed[next] = true;
+		for (int s = best; s < _slotCount; s += task.divisor)
+			load[s] += task.budget;
+	}
+
+	for (int s = 0; s < _slotCount; ++s)
+	{
+		_slotTasks[s] = 0;
+		for (int i = 0; i < _taskCount; ++i)
+		{
+			if ((s % _table[i].divisor) == _phase[i])
+				_slotTasks[s] |= (1u << i);
+		}
+	}
+	_slot = 0;
+
+	return true;
+}
+
+void CyclicExecutive::Run(void)
+{
+	const int64_t start = Now();
+	int64_t last = start;
+
+	for (uint32_t mask = _slotTasks[_slot]; mask; mask &= mask - 1)
+	{
+		const int i = __builtin_ctz(mask);
+
+		_table[i].func();
+
+		const int64_t now = Now();
+		const int64_t duration = now - last;
+		last = now;
+
+		Stats& stats = _stats[i];
+		stats.runs.store(stats.runs.load(std::memory_order_relaxed) + 1,
+				std::memory_order_relaxed);
+		stats.total.store(stats.total.load(std::memory_order_relaxed) + duration,
+				std::memory_order_relaxed);
+		if (duration > stats.max.load(std::memory_order_relaxed))
+			stats.max.store(duration, std::memory_order_relaxed);
+	}
+
+	const int64_t load = last - start;
+
+	_cycles.store(_cycles.load(std::memory_order_relaxed) + 1,
+			std::memory_order_relaxed);
+	_loadTotal.store(_loadTotal.load(std::memory_order_relaxed) + load,
+			std::memory_order_relaxed);
+	if (load > _loadMax.load(std::memory_order_relaxed))
+		_loadMax.store(load, std::memory_order_relaxed);
+	if (load > _slotMax[_slot].load(std::memory_order_relaxed))
+		_slotMax[_slot].store(load, std::memory_order_relaxed);
+
+	if (++_slot >= _slotCount)
+		_slot = 0;
+}
+
+void CyclicExecutive::Report(void) const
+{
+	uint64_t cycles = _cycles.load(std::memory_order_relaxed);
+	if (cycles == 0)
+		return;
+
+	std::cout << "cyclic executive: " << cycles << " cycles, hyperperiod "
+			<< _slotCount << ", load avg "
+			<< _loadTotal.load(std::memory_order_relaxed) / 1000.0 / cycles
+			<< " us, max " << _loadMax.load(std::memory_order_relaxed) / 1000.0
+			<< " us\n";
+
+	for (int i = 0; i < _taskCount; ++i)
+	{
+		uint64_t runs = _stats[i].runs.load(std::memory_order_relaxed);
+
+		std::cout << "  " << std::left << std::setw(24) << _table[i].name
+				<< std::right << " 1/" << _table[i].divisor << " phase "
+				<< _phase[i] << ", avg "
+				<< (runs ? _stats[i].total.load(std::memory_order_relaxed) / 1000.0 / runs : 0.0)
+				<< " us, max " << _stats[i].max.load(std::memory_order_relaxed) / 1000.0
+				<< " us\n";
+	}
+
+	std::cout << "  worst load per cycle [us]:";
+	for (int s = 0; s < _slotCount; ++s)
+		std::cout << " " << _slotMax[s].load(std::memory_order_relaxed) / 1000.0;
+	std::cout << "\n";
+}
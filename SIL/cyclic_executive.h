@@ -0,0 +1,116 @@
+/*
+ * cyclic_executive.h
+ *
+ * Created on: Oct 19, 2026
+ * Author: RockyLiu
+ *
+ * Multi-rate cyclic executive run by the SYNC timer callback.
+ *
+ * A static table lists the RT tasks with a rate divisor (run every n-th
+ * cycle) and a phase (the cycle modulo the divisor they run in). Init()
+ * builds, for every cycle of the hyperperiod (lcm of the divisors), the set
+ * of tasks to run as a bit mask, so Run() does no arithmetic per task.
+ *
+ * Tasks with phase AUTO_PHASE are staggered by Init(): largest budget first,
+ * each gets the phase that keeps the highest cycle load of the hyperperiod
+ * lowest, so slow tasks spread over the cycles instead of piling up on
+ * cycle 0.
+ *
+ * Every task run is timed with CLOCK_MONOTONIC (vDSO, no syscall), Report()
+ * prints average / max time per task and the worst load per cycle of the
+ * hyperperiod, to check the budgets of the table.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <time.h>
+
+class CyclicExecutive
+{
+public:
+	static constexpr int MAX_TASKS = 32;
+	static constexpr int MAX_SLOTS = 64;	// longest hyperperiod
+	static constexpr int AUTO_PHASE = -1;
+
+	struct Task
+	{
+		const char* name;
+		void (*func)(void);
+		int divisor;	// 1 -> every cycle, 4 -> every 4th cycle...
+		int phase;		// in [0, divisor), AUTO_PHASE -> staggered by Init()
+		double budget;	// us, expected execution time used for staggering
+	};
+
+	CyclicExecutive(const Task* table, int taskCount);
+	~CyclicExecutive() = default;
+
+	CyclicExecutive(const CyclicExecutive&) = delete;
+	CyclicExecutive&
+	operator=(const CyclicExecutive&) = delete;
+
+	/*
+	 * Non-RT, before the sync timer is created: check the table, place the
+	 * AUTO_PHASE tasks and build the schedule. False if the table is invalid.
+	 */
+	bool
+	Init(void);
+
+	/*
+	 * RT: run the tasks of this cycle, called from the SYNC timer.
+	 */
+	void
+	Run(void);
+
+	int
+	GetPhase(int task) const
+	{
+		return _phase[task];
+	}
+
+	/*
+	 * Longest cycle seen, ns.
+	 */
+	int64_t
+	GetMaxLoad(void) const
+	{
+		return _loadMax.load(std::memory_order_relaxed);
+	}
+
+	/*
+	 * Non-RT: print the schedule and the measured times to stdout.
+	 */
+	void
+	Report(void) const;
+
+private:
+	struct Stats
+	{
+		std::atomic<uint64_t> runs;
+		std::atomic<int64_t> total;		// ns
+		std::atomic<int64_t> max;		// ns
+	};
+
+	static int64_t
+	Now(void)
+	{
+		struct timespec ts;
+		clock_gettime(CLOCK_MONOTONIC, &ts);
+		return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+	}
+
+	const Task* _table;
+	int _taskCount;
+	int _phase[MAX_TASKS];
+
+	int _slotCount;				// hyperperiod, cycles
+	uint32_t _slotTasks[MAX_SLOTS];	// bit i -> task i runs in that cycle
+	int _slot;
+
+	Stats _stats[MAX_TASKS];
+	std::atomic<uint64_t> _cycles;
+	std::atomic<int64_t> _loadTotal;
+	std::atomic<int64_t> _loadMax;
+	std::atomic<int64_t> _slotMax[MAX_SLOTS];
+};
@@ -0,0 +1,421 @@
+/*
+ * feedforward.cpp
+ *
+ * Created on: Oct 19, 2026
+ * Author: RockyLiu
+ */
+
+#include "feedforward.h"
+#include <algorithm>
+#include <fstream>
+#include <limits>
+
+namespace
+{
+	constexpr int COLUMNS = 4;	// sign(v), v, 1, Stribeck
+	constexpr int STRIBECK_STEPS = 32;
+
+	/*
+	 * Least squares of the 'columns' first columns of a[] against t[], the
+	 * columns are normalized and the normal equations solved by Gauss
+	 * elimination. False if singular, 'sse' gets the squared residual sum.
+	 */
+	bool
+	Solve(const double (*a)[COLUMNS], const double* t, int rows, int columns,
+			double* x, double& sse)
+	{
+		double scale[COLUMNS];
+		double m[COLUMNS][COLUMNS + 1] =
+		{ };
+
+		for (int j = 0; j < columns; ++j)
+		{
+			scale[j] = 0.0;
+			for (int r = 0; r < rows; ++r)
+				scale[j] = std::max(scale[j], std::fabs(a[r][j]));
+			if (scale[j] <= 0.0)
+				return false;
+		}
+
+		for (int r = 0; r < rows; ++r)
+		{
+			for (int i = 0; i < columns; ++i)
+			{
+				for (int j = 0; j < columns; ++j)
+					m[i][j] += a[r][i] / scale[i] * a[r][j] / scale[j];
+				m[i][columns] += a[r][i] / scale[i] * t[r];
+			}
+		}
+
+		for (int k = 0; k < columns; ++k)
+		{
+			int pivot = k;
+			for (int i = k + 1; i < columns; ++i)
+			{
+				if (std::fabs(m[i][k]) > std::fabs(m[pivot][k]))
+					pivot = i;
+			}
+			if (std::fabs(m[pivot][k]) < 1e-12)
+				return false;
+
+			for (int j = 0; j <= columns; ++j)
+				std::swap(m[k][j], m[pivot][j]);
+
+			for (int i = k + 1; i < columns; ++i)
+			{
+				const double f = m[i][k] / m[k][k];
+				for (int j = k; j <= columns; ++j)
+					m[i][j] -= f * m[k][j];
+			}
+		}
+
+		for (int k = columns - 1; k >= 0; --k)
+		{
+			double sum = m[k][columns];
+			for (int j = k + 1; j < columns; ++j)
+				sum -= m[k][j] * x[j];
+			x[k] = sum / m[k][k];
+		}
+
+		for (int j = 0; j < columns; ++j)
+			x[j] /= scale[j];
+
+		sse = 0.0;
+		for (int r = 0; r < rows; ++r)
+		{
+			double e = t[r];
+			for (int j = 0; j < columns; ++j)
+				e -= a[r][j] * x[j];
+			sse += e * e;
+		}
+
+		return true;
+	}
+}
+
+const TorqueMap FeedforwardModel::_none;
+
+FeedforwardModel::FeedforwardModel() :
+		_block(MakeModel(FeedforwardParams())), _model(
+				MakeModel(FeedforwardParams())), _generation(0)
+{
+}
+
+FeedforwardModel::Model FeedforwardModel::MakeModel(
+		const FeedforwardParams& params)
+{
+	Model model;
+
+	model.coulomb = params.coulomb;
+	model.viscous = params.viscous;
+	model.stribeck = params.stribeck;
+	model.invStribeckVelocity = 1.0 / params.stribeckVelocity;
+	model.smoothing = params.smoothing;
+	model.offset = params.offset;
+	model.map = params.map ? params.map : &_none;
+	model.mapGain = params.mapGain;
+
+	return model;
+}
+
+bool FeedforwardModel::Configure(const FeedforwardParams& params)
+{
+	// smoothing 0 would give 0 / 0 at standstill
+	if ((params.smoothing <= 0.0) || (params.stribeckVelocity <= 0.0))
+		return false;
+
+	_block.Publish(MakeModel(params));
+
+	return true;
+}
+
+FrictionIdentifier::FrictionIdentifier(double ts) :
+		_ts(ts), _state(STATE::Idle), _abort(false), _setpoint(0.0), _segment(
+				0), _cycle(0), _settleCycles(0), _binScale(0.0)
+{
+}
+
+bool FrictionIdentifier::Start(const IdentParams& params)
+{
+	if (_state.load(std::memory_order_acquire) == STATE::Running)
+		return false;
+
+	if ((params.levels < 1) || (params.levels > IdentParams::MAX_LEVELS)
+			|| (params.dwell <= 0.0) || (params.period < 0.0))
+		return false;
+
+	for (int i = 0; i < params.levels; ++i)
+	{
+		if (params.velocity[i] <= 0.0)
+			return false;
+	}
+
+	_params = params;
+
+	_settleCycles = static_cast<long>(0.5 * params.dwell / _ts);
+
+	for (int i = 0; i < params.levels; ++i)
+	{
+		double record = 0.5 * params.dwell;
+
+		if (params.period > 0.0)
+		{
+			const double turn = params.period / params.velocity[i];
+			record = std::max(static_cast<double>(params.turns),
+					std::ceil(record / turn)) * turn;
+		}
+
+		_recordCycles[i] = std::max(1L, std::lround(record / _ts));
+	}
+	_binScale = (params.period > 0.0) ? 4294967296.0 / params.period : 0.0;
+
+	for (int k = 0; k < 2 * IdentParams::MAX_LEVELS; ++k)
+		_level[k] = Level
+		{ 0.0, 0.0, 0 };
+
+	for (int d = 0; d < 2; ++d)
+	{
+		for (int b = 0; b < BINS; ++b)
+		{
+			_binTorque[d][b] = 0.0;
+			_binCount[d][b] = 0;
+		}
+	}
+
+	_segment = 0;
+	_cycle = 0;
+	_setpoint = params.velocity[0];
+
+	_abort.store(false, std::memory_order_relaxed);
+	_state.store(STATE::Running, std::memory_order_release);
+
+	return true;
+}
+
+void FrictionIdentifier::Abort(void)
+{
+	if (_state.load(std::memory_order_acquire) == STATE::Running)
+		_abort.store(true, std::memory_order_release);
+}
+
+void FrictionIdentifier::Feed(const AxisState& state, double torque)
+{
+	if (_state.load(std::memory_order_relaxed) != STATE::Running)
+		return;
+
+	if (_abort.load(std::memory_order_acquire))
+	{
+		_abort.store(false, std::memory_order_relaxed);
+		_setpoint = 0.0;
+		_state.store(STATE::Idle, std::memory_order_release);
+		return;
+	}
+
+	if (_cycle >= _settleCycles)
+	{
+		Level& level = _level[_segment];
+		level.velocity += state.velocity;
+		level.torque += torque;
+		++level.count;
+
+		// first level, one table per direction
+		if (_segment < 2)
+		{
+			uint32_t phase = static_cast<uint32_t>(static_cast<int64_t>(state.position
+					* _binScale));
+			int bin = phase >> (32 - BITS);
+
+			_binTorque[_segment][bin] += torque;
+			++_binCount[_segment][bin];
+		}
+	}
+
+	if (++_cycle >= _settleCycles + _recordCycles[_segment >> 1])
+	{
+		_cycle = 0;
+
+		if (++_segment >= 2 * _params.levels)
+		{
+			_setpoint = 0.0;
+			_state.store(STATE::Done, std::memory_order_release);
+			return;
+		}
+
+		const double velocity = _params.velocity[_segment >> 1];
+		_setpoint = (_segment & 1) ? -velocity : velocity;
+	}
+}
+
+bool FrictionIdentifier::Fit(FeedforwardParams& params, double* rms) const
+{
+	if (_state.load(std::memory_order_acquire) != STATE::Done)
+		return false;
+
+	double v[2 * IdentParams::MAX_LEVELS];
+	double t[2 * IdentParams::MAX_LEVELS];
+	int count = GetLevels(v, t);
+
+	return FitLevels(v, t, count, params, rms);
+}
+
+int FrictionIdentifier::GetLevels(double* velocity, double* torque) const
+{
+	int count = 0;
+
+	for (int k = 0; k < 2 * _params.levels; ++k)
+	{
+		const Level& level = _level[k];
+		if (level.count == 0)
+			continue;
+
+		velocity[count] = level.velocity / level.count;
+		torque[count] = level.torque / level.count;
+		++count;
+	}
+
+	return count;
+}
+
+bool FrictionIdentifier::FitLevels(const double* velocity, const double* torque,
+		int count, FeedforwardParams& params, double* rms)
+{
+	double a[2 * IdentParams::MAX_LEVELS][COLUMNS];
+	double t[2 * IdentParams::MAX_LEVELS];
+	double v[2 * IdentParams::MAX_LEVELS];
+	double minSpeed = std::numeric_limits<double>::max(), maxSpeed = 0.0;
+	int rows = 0;
+
+	for (int k = 0; (k < count) && (k < 2 * IdentParams::MAX_LEVELS); ++k)
+	{
+		v[rows] = velocity[k];
+		t[rows] = torque[k];
+		a[rows][0] = (v[rows] >= 0.0) ? 1.0 : -1.0;
+		a[rows][1] = v[rows];
+		a[rows][2] = 1.0;
+		a[rows][3] = 0.0;
+
+		minSpeed = std::min(minSpeed, std::fabs(v[rows]));
+		maxSpeed = std::max(maxSpeed, std::fabs(v[rows]));
+		++rows;
+	}
+
+	// Coulomb, viscous and offset need 2 levels, the Stribeck term a 3rd one.
+	if (rows < 4)
+		return false;
+
+	double x[COLUMNS] =
+	{ }, best[COLUMNS] =
+	{ }, sse = 0.0, bestSse = 0.0;
+	double stribeckVelocity = 0.0;
+
+	if (!Solve(a, t, rows, 3, best, bestSse))
+		return false;
+
+	if (rows >= 6)
+	{
+		const double lo = 0.25 * minSpeed;
+		const double ratio = maxSpeed / lo;
+
+		for (int g = 0; g < STRIBECK_STEPS; ++g)
+		{
+			const double vs = lo * std::pow(ratio, g / (STRIBECK_STEPS - 1.0));
+
+			for (int r = 0; r < rows; ++r)
+			{
+				const double q = v[r] / vs;
+				a[r][3] = a[r][0] * std::exp(-q * q);
+			}
+
+			if (Solve(a, t, rows, COLUMNS, x, sse) && (x[0] >= 0.0) && (x[3] >= 0.0)
+					&& (sse < bestSse))
+			{
+				std::copy(x, x + COLUMNS, best);
+				bestSse = sse;
+				stribeckVelocity = vs;
+			}
+		}
+	}
+
+	params.coulomb = best[0];
+	params.viscous = best[1];
+	params.offset = best[2];
+	params.stribeck = best[3];
+	if (stribeckVelocity > 0.0)
+		params.stribeckVelocity = stribeckVelocity;
+
+	if (rms)
+		*rms = std::sqrt(bestSse / rows);
+
+	return true;
+}
+
+bool FrictionIdentifier::BuildMap(TorqueMap& map) const
+{
+	if ((_state.load(std::memory_order_acquire) != STATE::Done)
+			|| (_params.period <= 0.0))
+		return false;
+
+	double table[BINS];
+
+	for (int b = 0; b < BINS; ++b)
+	{
+		if ((_binCount[0][b] == 0) || (_binCount[1][b] == 0))
+			return false;
+
+		table[b] = 0.5
+				* (_binTorque[0][b] / _binCount[0][b]
+						+ _binTorque[1][b] / _binCount[1][b]);
+	}
+
+	// linear between the bin centers
+	map.Build(_params.period, [&table](double x)
+	{
+		const double f = x * BINS - 0.5;
+		const int i = static_cast<int>(std::floor(f));
+		const int i0 = (i + BINS) % BINS;
+		const int i1 = (i0 + 1) % BINS;
+
+		return table[i0] + (table[i1] - table[i0]) * (f - i);
+	});
+
+	return true;
+}
+
+bool FrictionIdentifier::Write(const char* fileName)
+{
+	if (_state.load(std::memory_order_acquire) != STATE::Done)
+		return false;
+
+	std::ofstream file(fileName);
+	if (!file.is_open())
+		return false;
+
+	file << "# velocity[counts/s]\ttorque\tsamples\n";
+
+	for (int k = 0; k < 2 * _params.levels; ++k)
+	{
+		const Level& level = _level[k];
+		if (level.count)
+			file << level.velocity / level.count << "\t"
+					<< level.torque / level.count << "\t" << level.count << "\n";
+	}
+
+	if (_params.period > 0.0)
+	{
+		file << "\n# position[counts]\ttorque_forward\ttorque_backward\n";
+
+		for (int b = 0; b < BINS; ++b)
+		{
+			file << (b + 0.5) * _params.period / BINS << "\t"
+					<< (_binCount[0][b] ? _binTorque[0][b] / _binCount[0][b] : 0.0)
+					<< "\t"
+					<< (_binCount[1][b] ? _binTorque[1][b] / _binCount[1][b] : 0.0)
+					<< "\n";
+		}
+	}
+
+	file.close();
+	_state.store(STATE::Idle, std::memory_order_release);
+
+	return !file.fail();
+}
@@ -0,0 +1,244 @@
+/*
+ * feedforward.h
+ *
+ * Created on: Oct 19, 2026
+ * Author: RockyLiu
+ *
+ * Friction and gravity feedforward of one axis in torque mode, and the
+ * identification of its parameters.
+ *
+ * FeedforwardModel adds, on top of the feedback torque:
+ * 	(coulomb + stribeck exp(-(v / stribeckVelocity)^2)) sign(v)
+ * 	+ viscous v + offset + mapGain map(position)
+ * sign(v) is smoothed to v / (|v| + smoothing) so the model does not chatter
+ * at standstill, the map is a TorqueMap (gravity over one turn, cogging
+ * over one pole pitch...). The evaluation has no branch, parameters are
+ * published as one set from the non-RT side.
+ *
+ * FrictionIdentifier drives the velocity setpoint of the axis through
+ * constant velocity levels, each one in both directions, and averages the
+ * velocity and torque over the second half of every level, stretched to
+ * whole map periods so a position dependent load averages out. The first
+ * level (the slowest) also fills a position table over 'turns' periods.
+ * Fit() then solves the friction parameters by least squares, grid
+ * searching the Stribeck velocity, and BuildMap() takes the direction
+ * independent part of the table, where Coulomb and viscous cancel.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include "haptic_effects.h"
+#include "param_block.h"
+#include "torque_map.h"
+
+struct FeedforwardParams
+{
+	double coulomb = 0.0;			// torque
+	double viscous = 0.0;			// torque per count/s
+	double stribeck = 0.0;			// breakaway torque above Coulomb
+	double stribeckVelocity = 1000.0;	// counts/s
+	double smoothing = 20.0;		// counts/s, width of the sign around 0
+	double offset = 0.0;			// torque, constant load (vertical linear axis)
+	const TorqueMap* map = nullptr;	// position dependent load, nullptr -> none
+	double mapGain = 1.0;
+};
+
+class FeedforwardModel
+{
+public:
+	FeedforwardModel();
+	~FeedforwardModel() = default;
+
+	FeedforwardModel(const FeedforwardModel&) = delete;
+	FeedforwardModel&
+	operator=(const FeedforwardModel&) = delete;
+
+	/*
+	 * Non-RT: publish a parameter set, false if it is invalid. A map in use
+	 * must not be rebuilt, build another one and publish it instead.
+	 */
+	bool
+	Configure(const FeedforwardParams& params);
+
+	/*
+	 * Non-RT: true once the RT side uses the last published set, a map
+	 * referenced only by older sets may be rebuilt then. Sets are picked up
+	 * while a function evaluating the model runs.
+	 */
+	bool
+	IsCurrent(void) const
+	{
+		return _acquired.load(std::memory_order_acquire) == _block.Generation();
+	}
+
+	/*
+	 * RT: feedforward torque of this cycle.
+	 */
+	double
+	operator()(const AxisState& state)
+	{
+		if (_block.TryRead(_model, _generation))
+			_acquired.store(_generation, std::memory_order_release);
+
+		const double v = state.velocity;
+		const double r = v * _model.invStribeckVelocity;
+		const double sign = v / (std::fabs(v) + _model.smoothing);
+
+		return (_model.coulomb + _model.stribeck * std::exp(-r * r)) * sign
+				+ _model.viscous * v + _model.offset
+				+ _model.mapGain * _model.map->Evaluate(state.position);
+	}
+
+private:
+	struct Model
+	{
+		double coulomb;
+		double viscous;
+		double stribeck;
+		double invStribeckVelocity;
+		double smoothing;
+		double offset;
+		const TorqueMap* map;	// never null, an empty map instead
+		double mapGain;
+	};
+
+	static Model
+	MakeModel(const FeedforwardParams& params);
+
+	static const TorqueMap _none;
+
+	ParamBlock<Model> _block;
+	Model _model;
+	unsigned int _generation;
+	std::atomic<unsigned int> _acquired;	// generation in use on the RT side
+};
+
+struct IdentParams
+{
+	static constexpr int MAX_LEVELS = 16;
+
+	int levels = 5;
+	double velocity[MAX_LEVELS] =
+	{ 2000.0, 4000.0, 8000.0, 16000.0, 32000.0 };	// counts/s, slowest first
+	double dwell = 1.0;		// s per level and direction, the first half settles
+	double period = 0.0;	// counts, of the position table, 0 -> none
+	int turns = 1;			// map periods recorded at least
+};
+
+class FrictionIdentifier
+{
+public:
+	static constexpr int BITS = 6;
+	static constexpr int BINS = 1 << BITS;	// of the position table
+
+	enum class STATE
+	{
+		Idle, Running, Done,
+	};
+
+	explicit
+	FrictionIdentifier(double ts = 0.00025);
+	~FrictionIdentifier() = default;
+
+	FrictionIdentifier(const FrictionIdentifier&) = delete;
+	FrictionIdentifier&
+	operator=(const FrictionIdentifier&) = delete;
+
+	/*
+	 * Non-RT: start a sweep, false if one is running or the levels are invalid.
+	 */
+	bool
+	Start(const IdentParams& params);
+
+	/*
+	 * Non-RT: abort a running sweep, the RT side goes idle on its next cycle.
+	 */
+	void
+	Abort(void);
+
+	/*
+	 * RT: velocity setpoint of the axis in this cycle, 0 when not running.
+	 */
+	double
+	GetSetpoint(void) const
+	{
+		return (_state.load(std::memory_order_acquire) == STATE::Running) ?
+				_setpoint : 0.0;
+	}
+
+	/*
+	 * RT: feedback of the axis and the torque applied in this cycle.
+	 */
+	void
+	Feed(const AxisState& state, double torque);
+
+	STATE
+	GetState(void) const
+	{
+		return _state.load(std::memory_order_acquire);
+	}
+
+	/*
+	 * Non-RT, once done: least squares friction parameters and constant
+	 * load in 'params', the other fields are left as they are. 'rms' gets
+	 * the residual torque. False if there are too few levels.
+	 */
+	bool
+	Fit(FeedforwardParams& params, double* rms = nullptr) const;
+
+	/*
+	 * Once done: mean velocity and torque of every recorded level into
+	 * 'velocity' / 'torque' (2 * MAX_LEVELS each), returns how many. RT
+	 * safe, for handing a copy of the sweep to another thread.
+	 */
+	int
+	GetLevels(double* velocity, double* torque) const;
+
+	/*
+	 * Any thread: the fit of Fit() on level means from GetLevels().
+	 */
+	static bool
+	FitLevels(const double* velocity, const double* torque, int count,
+			FeedforwardParams& params, double* rms = nullptr);
+
+	/*
+	 * Non-RT, once done: the position table into 'map', false if there is
+	 * no period or a bin was not crossed in both directions.
+	 */
+	bool
+	BuildMap(TorqueMap& map) const;
+
+	/*
+	 * Non-RT, once done: level means and position table to 'fileName', back to Idle.
+	 */
+	bool
+	Write(const char* fileName);
+
+private:
+	struct Level
+	{
+		double velocity;	// sums over the recorded cycles
+		double torque;
+		long count;
+	};
+
+	double _ts;
+	IdentParams _params;
+	std::atomic<STATE> _state;
+	std::atomic<bool> _abort;
+
+	// RT only
+	double _setpoint;
+	int _segment;			// level * 2 + direction
+	long _cycle;
+	long _settleCycles;
+	long _recordCycles[IdentParams::MAX_LEVELS];
+	double _binScale;		// phase per count
+
+	Level _level[2 * IdentParams::MAX_LEVELS];
+	double _binTorque[2][BINS];
+	long _binCount[2][BINS];
+};
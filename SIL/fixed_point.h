@@ -0,0 +1,163 @@
+/*
+ * fixed_point.h
+ *
+ * Created on: Oct 19, 2026
+ * Author: RockyLiu
+ *
+ * Q-format fixed point number, 32 bits storage with 'Frac' fraction bits,
+ * products and quotients use a 64 bits intermediate.
+ * e.g. QFormat<16> -> Q15.16, range [-32768, 32768), resolution 1.5e-5.
+ *
+ * Conversion from double is meant for the non-RT side (gains, limits),
+ * arithmetic is integer only. Every result saturates at the range of the
+ * format (computed in 64 bits, clamped, then narrowed), a controller output
+ * never wraps around to the other sign.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+template<int Frac>
+class QFormat
+{
+	static_assert(Frac > 0 && Frac < 31, "QFormat fraction bits must be in [1, 30]!");
+
+public:
+	static constexpr int32_t ONE = int32_t(1) << Frac;
+	static constexpr int32_t RAW_MAX = INT32_MAX;
+	static constexpr int32_t RAW_MIN = INT32_MIN;
+
+	constexpr
+	QFormat() :
+			_raw(0)
+	{
+	}
+
+	constexpr
+	QFormat(double value) :
+			_raw(
+					(value * ONE >= RAW_MAX) ? RAW_MAX :
+					(value * ONE <= RAW_MIN) ?
+							RAW_MIN :
+							static_cast<int32_t>(value * ONE + (value < 0 ? -0.5 : 0.5)))
+	{
+	}
+
+	static constexpr QFormat
+	FromRaw(int32_t raw)
+	{
+		return QFormat(raw, 0);
+	}
+
+	constexpr int32_t
+	Raw() const
+	{
+		return _raw;
+	}
+
+	explicit constexpr
+	operator double() const
+	{
+		return static_cast<double>(_raw) / ONE;
+	}
+
+	constexpr QFormat
+	operator-() const
+	{
+		return FromRaw(Saturate(-static_cast<int64_t>(_raw)));
+	}
+
+	friend constexpr QFormat
+	operator+(QFormat a, QFormat b)
+	{
+		return FromRaw(Saturate(static_cast<int64_t>(a._raw) + b._raw));
+	}
+
+	friend constexpr QFormat
+	operator-(QFormat a, QFormat b)
+	{
+		return FromRaw(Saturate(static_cast<int64_t>(a._raw) - b._raw));
+	}
+
+	friend constexpr QFormat
+	operator*(QFormat a, QFormat b)
+	{
+		return FromRaw(Saturate((static_cast<int64_t>(a._raw) * b._raw) >> Frac));
+	}
+
+	/*
+	 * Division by 0 gives the end of the range with the sign of 'a'.
+	 */
+	friend constexpr QFormat
+	operator/(QFormat a, QFormat b)
+	{
+		return FromRaw(
+				b._raw ? Saturate((static_cast<int64_t>(a._raw) * ONE) / b._raw) :
+				(a._raw < 0) ? RAW_MIN : RAW_MAX);
+	}
+
+	QFormat&
+	operator+=(QFormat b)
+	{
+		return *this = *this + b;
+	}
+
+	QFormat&
+	operator-=(QFormat b)
+	{
+		return *this = *this - b;
+	}
+
+	friend constexpr bool
+	operator<(QFormat a, QFormat b)
+	{
+		return a._raw < b._raw;
+	}
+
+	friend constexpr bool
+	operator>(QFormat a, QFormat b)
+	{
+		return a._raw > b._raw;
+	}
+
+	friend constexpr bool
+	operator<=(QFormat a, QFormat b)
+	{
+		return a._raw <= b._raw;
+	}
+
+	friend constexpr bool
+	operator>=(QFormat a, QFormat b)
+	{
+		return a._raw >= b._raw;
+	}
+
+	friend constexpr bool
+	operator==(QFormat a, QFormat b)
+	{
+		return a._raw == b._raw;
+	}
+
+	friend constexpr bool
+	operator!=(QFormat a, QFormat b)
+	{
+		return a._raw != b._raw;
+	}
+
+private:
+	static constexpr int32_t
+	Saturate(int64_t raw)
+	{
+		return (raw > RAW_MAX) ? RAW_MAX :
+				(raw < RAW_MIN) ? RAW_MIN : static_cast<int32_t>(raw);
+	}
+
+	constexpr
+	QFormat(int32_t raw, int) :
+			_raw(raw)
+	{
+	}
+
+	int32_t _raw;
+};
@@ -0,0 +1,161 @@
+/*
+ * freq_response.cpp
+ *
+ * Created on: Oct 19, 2026
+ * Author: RockyLiu
+ */
+
+#include "freq_response.h"
+#include <cmath>
+#include <fstream>
+
+FreqResponseAnalyzer::FreqResponseAnalyzer(double ts) :
+		_ts(ts), _state(STATE::Idle), _chirp(ts), _binCount(0), _length(0), _count(
+				0), _excitation(0.0), _velocityOffset(0.0), _positionPrev(0.0)
+{
+}
+
+bool FreqResponseAnalyzer::Start(const FreqResponseParams& params)
+{
+	if (_state.load(std::memory_order_acquire) == STATE::Running)
+		return false;
+
+	SignalParams chirp;
+	chirp.waveform = WAVEFORM::LogChirp;
+	chirp.amplitude = params.amplitude;
+	chirp.frequency = params.startFrequency;
+	chirp.endFrequency = params.endFrequency;
+	chirp.sweepTime = params.sweepTime;
+	if (!_chirp.Configure(chirp))
+		return false;
+
+	_binCount = params.binCount < 1 ? 1 : params.binCount;
+	if (_binCount > MAX_BINS)
+		_binCount = MAX_BINS;
+
+	double ratio =
+			(_binCount > 1) ?
+					std::pow(params.endFrequency / params.startFrequency,
+							1.0 / (_binCount - 1)) : 1.0;
+
+	for (int k = 0; k < _binCount; ++k)
+	{
+		double w = 6.2831853071795862 * params.startFrequency * std::pow(ratio, k)
+				* _ts;
+
+		_frequency[k] = params.startFrequency * std::pow(ratio, k);
+		_cos[k] = std::cos(w);
+		_sin[k] = std::sin(w);
+		_coeff[k] = 2.0 * _cos[k];
+
+		for (int ch = 0; ch < CH_COUNT; ++ch)
+		{
+			_s1[ch][k] = 0.0;
+			_s2[ch][k] = 0.0;
+		}
+	}
+
+	_length = static_cast<unsigned int>(params.sweepTime / _ts);
+	_count = 0;
+	_excitation = 0.0;
+
+	_state.store(STATE::Running, std::memory_order_release);
+
+	return true;
+}
+
+double FreqResponseAnalyzer::Excitation(void)
+{
+	if (_state.load(std::memory_order_acquire) != STATE::Running)
+		return 0.0;
+
+	_excitation = _chirp.Sample();
+
+	return _excitation;
+}
+
+void FreqResponseAnalyzer::Feed(double command, double velocity, double position)
+{
+	if (_state.load(std::memory_order_relaxed) != STATE::Running)
+		return;
+
+	// remove the operating point, the position is taken as increments so its
+	// drift does not leak into the bins, it is integrated back in WriteBode().
+	if (_count == 0)
+	{
+		_velocityOffset = velocity;
+		_positionPrev = position;
+	}
+
+	const double x[CH_COUNT] =
+	{ command, velocity - _velocityOffset, position - _positionPrev };
+
+	_positionPrev = position;
+
+	for (int ch = 0; ch < CH_COUNT; ++ch)
+	{
+		double* s1 = _s1[ch];
+		double* s2 = _s2[ch];
+
+		for (int k = 0; k < _binCount; ++k)
+		{
+			double s0 = x[ch] + _coeff[k] * s1[k] - s2[k];
+			s2[k] = s1[k];
+			s1[k] = s0;
+		}
+	}
+
+	if (++_count >= _length)
+		_state.store(STATE::Done, std::memory_order_release);
+}
+
+bool FreqResponseAnalyzer::WriteBode(const char* fileName)
+{
+	if (_state.load(std::memory_order_acquire) != STATE::Done)
+		return false;
+
+	std::ofstream file(fileName);
+	if (!file.is_open())
+		return false;
+
+	const double RAD2DEG = 57.295779513082323;
+
+	file << "# freq[Hz]\tvel_gain[dB]\tvel_phase[deg]\tpos_gain[dB]\tpos_phase[deg]\n";
+
+	for (int k = 0; k < _binCount; ++k)
+	{
+		// same DFT phase reference for all channels, it cancels in the ratio
+		double re[CH_COUNT], im[CH_COUNT];
+		for (int ch = 0; ch < CH_COUNT; ++ch)
+		{
+			re[ch] = _s1[ch][k] - _s2[ch][k] * _cos[k];
+			im[ch] = _s2[ch][k] * _sin[k];
+		}
+
+		// position bins hold the increments, divide by (1 - e^-jw)
+		double dr = 1.0 - _cos[k], di = _sin[k];
+		double dd = dr * dr + di * di;
+		double pr = (re[CH_POSITION] * dr + im[CH_POSITION] * di) / dd;
+		double pi = (im[CH_POSITION] * dr - re[CH_POSITION] * di) / dd;
+		re[CH_POSITION] = pr;
+		im[CH_POSITION] = pi;
+
+		double den = re[CH_COMMAND] * re[CH_COMMAND] + im[CH_COMMAND] * im[CH_COMMAND];
+
+		file << _frequency[k];
+		for (int ch = CH_VELOCITY; ch < CH_COUNT; ++ch)
+		{
+			// H = Y / U
+			double hr = (re[ch] * re[CH_COMMAND] + im[ch] * im[CH_COMMAND]) / den;
+			double hi = (im[ch] * re[CH_COMMAND] - re[ch] * im[CH_COMMAND]) / den;
+
+			file << '\t' << 20.0 * std::log10(std::sqrt(hr * hr + hi * hi)) << '\t'
+					<< std::atan2(hi, hr) * RAD2DEG;
+		}
+		file << '\n';
+	}
+
+	_state.store(STATE::Idle, std::memory_order_release);
+
+	return true;
+}
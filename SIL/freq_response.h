@@ -0,0 +1,112 @@
+/*
+ * freq_response.h
+ *
+ * Created on: Oct 19, 2026
+ * Author: RockyLiu
+ *
+ * On-controller frequency response analyzer.
+ *
+ * A log chirp is injected on top of the command, the injected command and
+ * the actual velocity / position are fed back every sync cycle, and each
+ * frequency bin is evaluated incrementally by a Goertzel filter per channel,
+ * so the RT cost is O(bins) multiply-adds per cycle. The ratio of the bins
+ * gives magnitude and phase of velocity / command and position / command,
+ * computed and written as Bode data on the non-RT side.
+ *
+ * Hand-off: the non-RT side only touches the analyzer while it is not
+ * running, Start() publishes the configuration with a release store of the
+ * state, the RT side publishes the results the same way when it is done.
+ */
+
+#pragma once
+
+#include <atomic>
+#include "signal_gen.h"
+
+struct FreqResponseParams
+{
+	double startFrequency = 1.0;	// Hz
+	double endFrequency = 200.0;	// Hz, below the Nyquist frequency or Start() fails
+	double sweepTime = 20.0;		// s
+	double amplitude = 0.05;		// command unit
+	int binCount = 40;				// log spaced in [start, end]
+};
+
+class FreqResponseAnalyzer
+{
+public:
+	static constexpr int MAX_BINS = 64;
+
+	enum class STATE
+	{
+		Idle, Running, Done,
+	};
+
+	explicit
+	FreqResponseAnalyzer(double ts = 0.00025);
+	~FreqResponseAnalyzer() = default;
+
+	FreqResponseAnalyzer(const FreqResponseAnalyzer&) = delete;
+	FreqResponseAnalyzer&
+	operator=(const FreqResponseAnalyzer&) = delete;
+
+	/*
+	 * Non-RT: configure and start a measurement, false if one is running or
+	 * the sweep is outside (0, fs/2).
+	 */
+	bool
+	Start(const FreqResponseParams& params);
+
+	/*
+	 * RT: excitation to add to the command of this cycle, 0 when not running.
+	 */
+	double
+	Excitation(void);
+
+	/*
+	 * RT: feed the command actually sent in this cycle (including the
+	 * excitation) and the measured response, O(bins).
+	 */
+	void
+	Feed(double command, double velocity, double position);
+
+	STATE
+	GetState(void) const
+	{
+		return _state.load(std::memory_order_acquire);
+	}
+
+	/*
+	 * Non-RT: compute the Bode data and write it to a text file, one line
+	 * per bin: frequency [Hz], velocity gain [dB], velocity phase [deg],
+	 * position gain [dB], position phase [deg]. The analyzer goes back to idle.
+	 */
+	bool
+	WriteBode(const char* fileName);
+
+private:
+	enum
+	{
+		CH_COMMAND, CH_VELOCITY, CH_POSITION, CH_COUNT,
+	};
+
+	double _ts;
+	std::atomic<STATE> _state;
+	SignalGenerator _chirp;
+
+	int _binCount;
+	unsigned int _length;		// samples of the sweep
+	unsigned int _count;
+	double _excitation;
+	double _velocityOffset;
+	double _positionPrev;
+
+	double _frequency[MAX_BINS];
+	double _coeff[MAX_BINS];	// 2 * cos(w)
+	double _cos[MAX_BINS];
+	double _sin[MAX_BINS];
+
+	// Goertzel states, s[n-1] and s[n-2] per channel and bin
+	double _s1[CH_COUNT][MAX_BINS];
+	double _s2[CH_COUNT][MAX_BINS];
+};
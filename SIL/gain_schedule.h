@@ -0,0 +1,152 @@
+/*
+ * gain_schedule.h
+ *
+ * Created on: Oct 19, 2026
+ * Author: RockyLiu
+ *
+ * Gain scheduling table, kp / ki / kd / output limit at breakpoints of a
+ * scheduling variable (speed, position or load estimate), interpolated
+ * linearly in between and held constant outside.
+ *
+ * The whole table is published as one set from the non-RT side and picked
+ * up by Refresh() at the start of a cycle, so all lanes of one cycle use
+ * the same table. Lookup() finds the segment with a binary search of a
+ * fixed number of steps for a given table size, no data dependent loop.
+ *
+ * The gains are applied with PIDBank::Schedule(), which keeps the output
+ * continuous when they change (bumpless).
+ */
+
+#pragma once
+
+#include "param_block.h"
+
+enum class SCHEDULE
+{
+	None, Speed, Position, Load,
+};
+
+struct GainSet
+{
+	double kp;
+	double ki;
+	double kd;
+	double limit;
+};
+
+template<int MaxPoints = 16>
+class GainSchedule
+{
+	static_assert(MaxPoints >= 2, "GainSchedule needs at least 2 breakpoints!");
+
+public:
+	static constexpr int MAX_POINTS = MaxPoints;
+
+	struct Table
+	{
+		SCHEDULE variable;
+		int count;
+		double x[MaxPoints];			// ascending
+		GainSet gains[MaxPoints];
+	};
+
+	GainSchedule() :
+			_block(Table
+			{ SCHEDULE::None, 0, { }, { } }), _table(Table
+			{ SCHEDULE::None, 0, { }, { } }), _generation(0)
+	{
+	}
+	~GainSchedule() = default;
+
+	GainSchedule(const GainSchedule&) = delete;
+	GainSchedule&
+	operator=(const GainSchedule&) = delete;
+
+	/*
+	 * Non-RT: publish 'count' breakpoints of 'variable', x strictly
+	 * ascending. SCHEDULE::None or count 0 disables the schedule.
+	 */
+	bool
+	Configure(SCHEDULE variable, const double* x, const GainSet* gains, int count)
+	{
+		if ((count < 0) || (count > MaxPoints))
+			return false;
+
+		for (int i = 1; i < count; ++i)
+		{
+			if (!(x[i] > x[i - 1]))
+				return false;
+		}
+
+		Table table
+		{ variable, count, { }, { } };
+
+		if (variable == SCHEDULE::None)
+			table.count = 0;
+
+		for (int i = 0; i < table.count; ++i)
+		{
+			table.x[i] = x[i];
+			table.gains[i] = gains[i];
+		}
+		if (table.count == 0)
+			table.variable = SCHEDULE::None;
+
+		_block.Publish(table);
+
+		return true;
+	}
+
+	/*
+	 * RT: pick up a new table, once per cycle before Lookup().
+	 */
+	void
+	Refresh(void)
+	{
+		_block.TryRead(_table, _generation);
+	}
+
+	/*
+	 * RT: variable the table is indexed by, SCHEDULE::None when disabled.
+	 */
+	SCHEDULE
+	GetVariable(void) const
+	{
+		return _table.variable;
+	}
+
+	/*
+	 * RT: gains at 'x', the table must not be empty.
+	 */
+	GainSet
+	Lookup(double x) const
+	{
+		const int n = _table.count;
+		int base = 0;
+
+		// last breakpoint <= x, or the first one
+		for (int length = n; length > 1;)
+		{
+			const int half = length / 2;
+			base = (x >= _table.x[base + half]) ? base + half : base;
+			length -= half;
+		}
+
+		const int next = (base + 1 < n) ? base + 1 : base;
+		const double span = _table.x[next] - _table.x[base];
+		double t = (span > 0.0) ? (x - _table.x[base]) / span : 0.0;
+		t = (t < 0.0) ? 0.0 : ((t > 1.0) ? 1.0 : t);
+
+		const GainSet& a = _table.gains[base];
+		const GainSet& b = _table.gains[next];
+
+		return
+		{	a.kp + (b.kp - a.kp) * t, a.ki + (b.ki - a.ki) * t, a.kd + (b.kd - a.kd) * t,
+			a.limit + (b.limit - a.limit) * t};
+	}
+
+private:
+	ParamBlock<Table> _block;
+	Table _table;	// RT copy
+	unsigned int _generation;
+};
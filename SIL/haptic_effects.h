@@ -0,0 +1,426 @@
+/*
+ * haptic_effects.h
+ *
+ * Created on: Oct 19, 2026
+ * Author: RockyLiu
+ *
+ * Haptic effects for torque mode, each one a small stateful object with the
+ * same interface:
+ * 	explicit Effect(const Effect::Config&, double ts);
+ * 	double operator()(const AxisState&);	// torque contribution, RT
+ *
+ * They are combined in two ways, both summing the contributions and
+ * limiting the total once per cycle:
+ * 	EffectChain<Effects...>		fixed at compile time, calls are inlined.
+ * 	EffectPipeline<MaxEffects>	configured at run time, a flat array of
+ * 								preallocated slots evaluated in one pass.
+ */
+
+#pragma once
+
+#include <cmath>
+#include <new>
+#include <initializer_list>
+#include "pid.h"
+#include "param_block.h"
+#include "torque_map.h"
+#include "virtual_fixture.h"
+
+/**
+ * Feedback of one axis in this cycle.
+ */
+struct AxisState
+{
+	double position;
+	double velocity;
+};
+
+enum class EFFECT
+{
+	None, Smooth, Damp, Ratchet, Wall, Map, Fixture,
+};
+
+/*
+ * Assists the motion, torque proportional to the velocity with ramp & limit.
+ */
+class SmoothEffect
+{
+public:
+	struct Config
+	{
+		double kp;
+		double ramp;
+		double limit;
+	};
+
+	explicit
+	SmoothEffect(const Config& config, double ts = 0.00025) :
+			_pid(config.kp, 0.0, 0.0, config.ramp, config.limit, ts)
+	{
+	}
+
+	double
+	operator()(const AxisState& state)
+	{
+		return _pid(state.velocity);
+	}
+
+private:
+	PController _pid;
+};
+
+/*
+ * Viscous damping, opposes the velocity.
+ */
+class DampEffect
+{
+public:
+	struct Config
+	{
+		double kd;
+	};
+
+	explicit
+	DampEffect(const Config& config, double = 0.00025) :
+			_kd(config.kd)
+	{
+	}
+
+	double
+	operator()(const AxisState& state)
+	{
+		return -_kd * state.velocity;
+	}
+
+private:
+	double _kd;
+};
+
+/*
+ * Pulls the axis to the nearest of equally spaced detents.
+ */
+class RatchetEffect
+{
+public:
+	struct Config
+	{
+		double distance;	// between 2 detents, feedback counts
+		double kp;
+		double ramp;
+		double limit;
+	};
+
+	explicit
+	RatchetEffect(const Config& config, double ts = 0.00025) :
+			_distance(config.distance), _invDistance(1.0 / config.distance), _pid(
+					config.kp, 0.0, 0.0, config.ramp, config.limit, ts)
+	{
+	}
+
+	double
+	operator()(const AxisState& state)
+	{
+		double target = std::round(state.position * _invDistance) * _distance;
+		return _pid(target - state.position);
+	}
+
+private:
+	double _distance;
+	double _invDistance;
+	PController _pid;
+};
+
+/*
+ * Torque read from a precomputed periodic map (detents, clicks...), scaled.
+ */
+class TorqueMapEffect
+{
+public:
+	struct Config
+	{
+		const TorqueMap* map;	// built before the effect is configured
+		double gain;
+	};
+
+	explicit
+	TorqueMapEffect(const Config& config, double = 0.00025) :
+			_map(config.map), _gain(config.gain)
+	{
+	}
+
+	double
+	operator()(const AxisState& state)
+	{
+		return _gain * _map->Evaluate(state.position);
+	}
+
+private:
+	const TorqueMap* _map;
+	double _gain;
+};
+
+/*
+ * Virtual walls, free motion in [left, right], spring outside.
+ */
+class WallEffect
+{
+public:
+	struct Config
+	{
+		double left;
+		double right;
+		double kp;
+		double ramp;
+		double limit;
+	};
+
+	explicit
+	WallEffect(const Config& config, double ts = 0.00025) :
+			_left(config.left), _right(config.right), _pid(config.kp, 0.0, 0.0,
+					config.ramp, config.limit, ts)
+	{
+	}
+
+	double
+	operator()(const AxisState& state)
+	{
+		double penetration =
+				(state.position < _left) ? (_left - state.position) :
+				(state.position > _right) ? (_right - state.position) : 0.0;
+
+		return _pid(penetration);
+	}
+
+private:
+	double _left;
+	double _right;
+	PController _pid;
+};
+
+/*
+ * Many walls / keep-out intervals of one axis, see VirtualFixtures.
+ */
+class FixtureEffect
+{
+public:
+	struct Config
+	{
+		VirtualFixtures<1>* fixtures;	// fixture sets swapped through VirtualFixtures::Publish()
+	};
+
+	explicit
+	FixtureEffect(const Config& config, double = 0.00025) :
+			_fixtures(config.fixtures)
+	{
+	}
+
+	double
+	operator()(const AxisState& state)
+	{
+		double torque;
+		(*_fixtures)(&state.position, &state.velocity, &torque);
+		return torque;
+	}
+
+private:
+	VirtualFixtures<1>* _fixtures;
+};
+
+/*
+ * Compile-time chain, e.g.
+ * 	EffectChain<RatchetEffect, DampEffect> chain {limit, {ratchet...}, {damp...}};
+ * An effect type may appear only once in a chain.
+ */
+template<typename ... Effects>
+class EffectChain : private Effects...
+{
+public:
+	explicit
+	EffectChain(double limit, const typename Effects::Config&... configs,
+			double ts = 0.00025) :
+			Effects(configs, ts)..., _limit(limit)
+	{
+	}
+
+	EffectChain(const EffectChain&) = delete;
+	EffectChain&
+	operator=(const EffectChain&) = delete;
+
+	double
+	operator()(const AxisState& state)
+	{
+		double torque = 0.0;
+		(void) std::initializer_list<int>
+		{ 0, (torque += static_cast<Effects&>(*this)(state), 0)... };
+
+		return _constrain(torque, -_limit, _limit);
+	}
+
+private:
+	double _limit;
+};
+
+/**
+ * Run-time configuration of one pipeline slot.
+ */
+struct EffectConfig
+{
+	EFFECT kind;
+	union
+	{
+		SmoothEffect::Config smooth;
+		DampEffect::Config damp;
+		RatchetEffect::Config ratchet;
+		WallEffect::Config wall;
+		TorqueMapEffect::Config map;
+		FixtureEffect::Config fixture;
+	};
+};
+
+/*
+ * Run-time pipeline. Configure() may be called from the non-RT side at any
+ * time, the RT side rebuilds its slots in place (no allocation) on the next
+ * cycle, effect states start over at that point.
+ */
+template<int MaxEffects>
+class EffectPipeline
+{
+public:
+	struct Config
+	{
+		int count;
+		double limit;
+		EffectConfig effect[MaxEffects];
+	};
+
+	explicit
+	EffectPipeline(double ts = 0.00025) :
+			_ts(ts), _block(Config
+			{ 0, 0.0, { } }), _generation(0), _count(0), _limit(0.0)
+	{
+	}
+
+	EffectPipeline(const EffectPipeline&) = delete;
+	EffectPipeline&
+	operator=(const EffectPipeline&) = delete;
+
+	/*
+	 * Non-RT: publish a new chain, returns its generation.
+	 */
+	unsigned int
+	Configure(const Config& config)
+	{
+		return _block.Publish(config);
+	}
+
+	/*
+	 * RT: total torque of the chain, limited.
+	 */
+	double
+	operator()(const AxisState& state)
+	{
+		Config config;
+		if (_block.TryRead(config, _generation))
+			Build(config);
+
+		double torque = 0.0;
+
+		for (int i = 0; i < _count; ++i)
+		{
+			Slot& slot = _slots[i];
+
+			switch (slot.kind)
+			{
+			case EFFECT::Smooth:
+				torque += slot.smooth(state);
+				break;
+			case EFFECT::Damp:
+				torque += slot.damp(state);
+				break;
+			case EFFECT::Ratchet:
+				torque += slot.ratchet(state);
+				break;
+			case EFFECT::Wall:
+				torque += slot.wall(state);
+				break;
+			case EFFECT::Map:
+				torque += slot.map(state);
+				break;
+			case EFFECT::Fixture:
+				torque += slot.fixture(state);
+				break;
+			case EFFECT::None:
+				break;
+			}
+		}
+
+		return _constrain(torque, -_limit, _limit);
+	}
+
+private:
+	struct Slot
+	{
+		Slot() :
+				kind(EFFECT::None)
+		{
+		}
+
+		EFFECT kind;
+		union
+		{
+			SmoothEffect smooth;
+			DampEffect damp;
+			RatchetEffect ratchet;
+			WallEffect wall;
+			TorqueMapEffect map;
+			FixtureEffect fixture;
+		};
+	};
+
+	void
+	Build(const Config& config)
+	{
+		_count = config.count > MaxEffects ? MaxEffects : config.count;
+		_limit = config.limit;
+
+		for (int i = 0; i < _count; ++i)
+		{
+			const EffectConfig& effect = config.effect[i];
+			Slot& slot = _slots[i];
+
+			slot.kind = effect.kind;
+
+			switch (effect.kind)
+			{
+			case EFFECT::Smooth:
+				new (&slot.smooth) SmoothEffect(effect.smooth, _ts);
+				break;
+			case EFFECT::Damp:
+				new (&slot.damp) DampEffect(effect.damp, _ts);
+				break;
+			case EFFECT::Ratchet:
+				new (&slot.ratchet) RatchetEffect(effect.ratchet, _ts);
+				break;
+			case EFFECT::Wall:
+				new (&slot.wall) WallEffect(effect.wall, _ts);
+				break;
+			case EFFECT::Map:
+				new (&slot.map) TorqueMapEffect(effect.map, _ts);
+				break;
+			case EFFECT::Fixture:
+				new (&slot.fixture) FixtureEffect(effect.fixture, _ts);
+				break;
+			case EFFECT::None:
+				break;
+			}
+		}
+	}
+
+	double _ts;
+	ParamBlock<Config> _block;
+	unsigned int _generation;
+
+	int _count;
+	double _limit;
+	Slot _slots[MaxEffects];
+};
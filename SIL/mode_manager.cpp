@@ -0,0 +1,195 @@
+/*
+ * mode_manager.cpp
+ *
+ * Created on: Oct 19, 2026
+ * Author: RockyLiu
+ */
+
+#include "mode_manager.h"
+#include <syslog.h>
+
+#define OPMODE_TIMEOUT_MS		1000
+#define SLOT_ACK_TIMEOUT_MS		100
+
+namespace
+{
+	OPM402
+	ToOpMode(MOTIONMODE mode)
+	{
+		switch (mode)
+		{
+		case MOTIONMODE::PMode:
+			return OPM402_CYCLIC_SYNC_POSITION_MODE;
+		case MOTIONMODE::VMode:
+			return OPM402_CYCLIC_SYNC_VELOCITY_MODE;
+		case MOTIONMODE::TMode:
+		default:
+			return OPM402_CYCLIC_SYNC_TORQUE_MODE;
+		}
+	}
+
+	MMC_PARAMETER_LIST_ENUM
+	ToSource(MOTIONMODE mode)
+	{
+		switch (mode)
+		{
+		case MOTIONMODE::PMode:
+			return MMC_UCUSER607A_SRC;
+		case MOTIONMODE::VMode:
+			return MMC_UCUSER60FF_SRC;
+		case MOTIONMODE::TMode:
+		default:
+			return MMC_UCUSER6071_SRC;
+		}
+	}
+}
+
+ModeManager::ModeManager(CMMCRTSingleAxis* axes, int axisCount,
+		const Entry* table, int entryCount) :
+		_axes(axes), _axisCount(axisCount), _table(table), _entryCount(
+				entryCount), _active(nullptr), _running(nullptr), _index(-1), _mode(
+				MOTIONMODE::TMode)
+{
+}
+
+bool ModeManager::EnterOpMode(CMMCRTSingleAxis& axis, MOTIONMODE mode)
+{
+	RequestOpMode(axis, mode);
+
+	int timeout = OPMODE_TIMEOUT_MS;
+	while (!CompleteOpMode(axis, mode))
+	{
+		if (--timeout < 0)
+			return false;
+		usleep(1000);
+	}
+
+	return true;
+}
+
+void ModeManager::RequestOpMode(CMMCRTSingleAxis& axis, MOTIONMODE mode)
+{
+	// 0 - NC profiler
+	// 1 - 0;
+	// 2 - User
+	axis.SetBoolParameter(0, ToSource(mode), 0);
+	axis.SetOpMode(ToOpMode(mode));
+}
+
+bool ModeManager::CompleteOpMode(CMMCRTSingleAxis& axis, MOTIONMODE mode)
+{
+	if (axis.GetOpMode() != ToOpMode(mode))
+		return false;
+
+	// preload the user command with the actual state, no bump when the source changes.
+	switch (mode)
+	{
+	case MOTIONMODE::PMode:
+		axis.SetUser607A(static_cast<int>(axis.GetActualPosition()));
+		break;
+	case MOTIONMODE::VMode:
+		axis.SetUser60FF(static_cast<int>(axis.GetActualVelocity()));
+		break;
+	case MOTIONMODE::TMode:
+		axis.SetUser6071(axis.GetActualTorque());
+		break;
+	}
+
+	axis.SetBoolParameter(2, ToSource(mode), 0);
+
+	return true;
+}
+
+void ModeManager::LeaveOpMode(CMMCRTSingleAxis& axis, MOTIONMODE mode)
+{
+	// NC profiler first, the user command below is not applied any more.
+	axis.SetBoolParameter(0, ToSource(mode), 0);
+
+	switch (mode)
+	{
+	case MOTIONMODE::PMode:
+		axis.SetUser607A(static_cast<int>(axis.GetActualPosition()));
+		break;
+	case MOTIONMODE::VMode:
+		axis.SetUser60FF(0);
+		break;
+	case MOTIONMODE::TMode:
+		axis.SetUser6071(0.0);
+		break;
+	}
+}
+
+bool ModeManager::Init(int index)
+{
+	if (index < 0 || index >= _entryCount)
+		return false;
+
+	MOTIONMODE mode = _table[index].mode;
+
+	for (int i = 0; i < _axisCount; ++i)
+	{
+		if (_axes[i].GetOpMode() != ToOpMode(mode))
+		{
+			syslog(LOG_ERR, "axis %d is not in the op-mode of <%s>\n", i,
+					_table[index].name);
+			return false;
+		}
+	}
+
+	_mode.store(mode, std::memory_order_release);
+	_index.store(index, std::memory_order_release);
+	_active.store(_table[index].func, std::memory_order_release);
+
+	return true;
+}
+
+bool ModeManager::Switch(int index)
+{
+	if (index < 0 || index >= _entryCount)
+		return false;
+
+	MOTIONMODE from = _mode.load(std::memory_order_acquire);
+	MOTIONMODE to = _table[index].mode;
+
+	if (from != to)
+	{
+		// stop writing commands before the op-mode changes under the RT side,
+		// watchdog overrides are refused from now on (empty slot).
+		_active.store(nullptr, std::memory_order_release);
+		_index.store(-1, std::memory_order_release);
+
+		// a cycle which loaded the empty slot -> the last one running the
+		// old function is over.
+		int timeout = SLOT_ACK_TIMEOUT_MS * 4;
+		while (_running.load(std::memory_order_acquire) != nullptr)
+		{
+			if (--timeout < 0)
+			{
+				syslog(LOG_ERR, "the SYNC callback did not acknowledge the empty slot\n");
+				return false;
+			}
+			usleep(250);
+		}
+
+		for (int i = 0; i < _axisCount; ++i)
+		{
+			LeaveOpMode(_axes[i], from);
+
+			if (!EnterOpMode(_axes[i], to))
+			{
+				syslog(LOG_ERR, "axis %d did not enter the op-mode of <%s>\n", i,
+						_table[index].name);
+				return false;
+			}
+		}
+
+		_mode.store(to, std::memory_order_release);
+	}
+
+	_index.store(index, std::memory_order_release);
+	_active.store(_table[index].func, std::memory_order_release);
+
+	syslog(LOG_INFO, "SIL function switched to <%s>\n", _table[index].name);
+
+	return true;
+}
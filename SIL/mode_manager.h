@@ -0,0 +1,154 @@
+/*
+ * mode_manager.h
+ *
+ * Created on: Oct 19, 2026
+ * Author: RockyLiu
+ *
+ * Run-time switching of the SIL function executed by the SYNC timer.
+ *
+ * The RT callback only loads one atomic function slot and calls it, so a
+ * new function takes effect on the next sync cycle. When the new function
+ * needs another op-mode (CSP / CSV / CST), Switch() empties the slot, moves
+ * the axes to the new mode with the user command preloaded from the actual
+ * feedback (bumpless), and only then publishes the new function.
+ */
+
+#pragma once
+
+#include <atomic>
+#include "mmcpplib.h"
+
+/**
+ * Motion mode list
+ */
+enum class MOTIONMODE
+{
+	PMode, VMode, TMode,
+};
+
+typedef void (*SilFunc)(void);
+
+class ModeManager
+{
+public:
+	struct Entry
+	{
+		const char* name;
+		SilFunc func;
+		MOTIONMODE mode;
+	};
+
+	ModeManager(CMMCRTSingleAxis* axes, int axisCount, const Entry* table,
+			int entryCount);
+	~ModeManager() = default;
+
+	ModeManager(const ModeManager&) = delete;
+	ModeManager&
+	operator=(const ModeManager&) = delete;
+
+	/*
+	 * Non-RT, before the sync timer is created: select entry 'index', the
+	 * axes are already in its op-mode with the user command source (see
+	 * AxisBringUp). Returns false if an axis reports another op-mode.
+	 */
+	bool
+	Init(int index);
+
+	/*
+	 * Non-RT: switch to entry 'index', blocks until the op-mode transition
+	 * is done. Returns false if the index is invalid, the RT side did not
+	 * acknowledge the empty slot or an axis did not reach the new op-mode,
+	 * the slot stays empty in the last two cases.
+	 */
+	bool
+	Switch(int index);
+
+	/*
+	 * RT: run the active function, called from the SYNC timer. The slot
+	 * loaded is acknowledged first, the previous cycle is over by then.
+	 */
+	void
+	Run(void)
+	{
+		SilFunc func = _active.load(std::memory_order_acquire);
+		_running.store(func, std::memory_order_release);
+		if (func)
+			func();
+	}
+
+	/*
+	 * RT or non-RT: replace the running function without op-mode change,
+	 * e.g. by a watchdog fallback. Refused (false) while the slot is empty,
+	 * which includes a Switch() in progress.
+	 */
+	bool
+	Override(SilFunc func)
+	{
+		SilFunc current = _active.load(std::memory_order_acquire);
+
+		return current
+				&& _active.compare_exchange_strong(current, func,
+						std::memory_order_acq_rel);
+	}
+
+	int
+	GetIndex(void) const
+	{
+		return _index.load(std::memory_order_acquire);
+	}
+
+	MOTIONMODE
+	GetMotionMode(void) const
+	{
+		return _mode.load(std::memory_order_acquire);
+	}
+
+	const Entry&
+	GetEntry(int index) const
+	{
+		return _table[index];
+	}
+
+	int
+	GetEntryCount(void) const
+	{
+		return _entryCount;
+	}
+
+	/*
+	 * Move one axis to the op-mode, user command preloaded from the
+	 * actual feedback, then switch the command source to user.
+	 */
+	static bool
+	EnterOpMode(CMMCRTSingleAxis& axis, MOTIONMODE mode);
+
+	/*
+	 * The two halves of EnterOpMode() for callers waiting on several axes
+	 * at once. RequestOpMode() gives the command to the NC profiler and asks
+	 * for the op-mode, CompleteOpMode() is false until the drive reports it,
+	 * then preloads the user command and switches the source to user.
+	 */
+	static void
+	RequestOpMode(CMMCRTSingleAxis& axis, MOTIONMODE mode);
+
+	static bool
+	CompleteOpMode(CMMCRTSingleAxis& axis, MOTIONMODE mode);
+
+	/*
+	 * Give the command of the mode back to the NC profiler, then preload
+	 * the user command from the actual feedback (position) or with 0.
+	 */
+	static void
+	LeaveOpMode(CMMCRTSingleAxis& axis, MOTIONMODE mode);
+
+private:
+	CMMCRTSingleAxis* _axes;
+	int _axisCount;
+	const Entry* _table;
+	int _entryCount;
+
+	std::atomic<SilFunc> _active;
+	std::atomic<SilFunc> _running;	// slot loaded by the last RT cycle
+	std::atomic<int> _index;
+	std::atomic<MOTIONMODE> _mode;
+};
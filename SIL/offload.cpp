@@ -0,0 +1,334 @@
+/*
+ * offload.cpp
+ *
+ * Created on: Oct 19, 2026
+ * Author: RockyLiu
+ */
+
+#include "offload.h"
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+
+namespace
+{
+	void
+	Echo(const OffloadJob& job, OffloadResult& result)
+	{
+		for (int i = 0; i < 8; ++i)
+			result.value[i] = job.arg[i];
+	}
+}
+
+OffloadPool::OffloadPool() :
+		_workerCount(0), _running(false), _nextId(0), _nextWorker(0), _pollWorker(
+				0), _posted(0), _dropped(0)
+{
+	for (int i = 0; i < MAX_TYPES; ++i)
+	{
+		_work[i] = nullptr;
+		_done[i] = nullptr;
+	}
+	_work[ECHO] = Echo;
+
+	for (int i = 0; i < MAX_WORKERS; ++i)
+		sem_init(&_workers[i].wake, 0, 0);
+}
+
+OffloadPool::~OffloadPool()
+{
+	Stop();
+
+	for (int i = 0; i < MAX_WORKERS; ++i)
+		sem_destroy(&_workers[i].wake);
+}
+
+bool OffloadPool::Register(int type, WorkHandler work, DoneHandler done)
+{
+	if ((type <= ECHO) || (type >= MAX_TYPES) || _running.load())
+		return false;
+
+	_work[type] = work;
+	_done[type] = done;
+
+	return true;
+}
+
+bool OffloadPool::Start(const WorkerParams& params)
+{
+	if (_running.load())
+		return false;
+
+	_params = params;
+	_workerCount = params.workers;
+	if (_workerCount < 1)
+		_workerCount = 1;
+	if (_workerCount > MAX_WORKERS)
+		_workerCount = MAX_WORKERS;
+
+	_nextWorker = 0;
+	_pollWorker = 0;
+	_running.store(true);
+
+	for (int i = 0; i < _workerCount; ++i)
+	{
+		try
+		{
+			_workers[i].thread = std::thread(&OffloadPool::Work, this, i);
+		} catch (const std::system_error& e)
+		{
+			std::cerr << "offload: can not start worker " << i << ", " << e.what()
+					<< "\n";
+			_workerCount = i;
+			Stop();
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void OffloadPool::Stop(void)
+{
+	if (!_running.exchange(false))
+		return;
+
+	for (int i = 0; i < _workerCount; ++i)
+		sem_post(&_workers[i].wake);
+
+	for (int i = 0; i < _workerCount; ++i)
+	{
+		if (_workers[i].thread.joinable())
+			_workers[i].thread.join();
+
+		OffloadJob job;
+		OffloadResult result;
+		while (_workers[i].jobs.Pop(job))
+			;
+		while (_workers[i].results.Pop(result))
+			;
+	}
+}
+
+int64_t OffloadPool::Now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+void OffloadPool::Work(int index)
+{
+	Worker& worker = _workers[index];
+
+	if (_params.cpuMask)
+	{
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		for (int cpu = 0; cpu < static_cast<int>(8 * sizeof(_params.cpuMask)); ++cpu)
+		{
+			if (_params.cpuMask & (1UL << cpu))
+				CPU_SET(cpu, &set);
+		}
+
+		int error = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+		if (error)
+			std::cerr << "offload: worker " << index << " affinity, "
+					<< strerror(error) << "\n";
+	}
+
+	// explicit, the workers would inherit the policy of the creating thread otherwise.
+	struct sched_param param;
+	param.sched_priority = _params.priority;
+	int error = pthread_setschedparam(pthread_self(),
+			(_params.priority > 0) ? SCHED_FIFO : SCHED_OTHER, &param);
+	if (error)
+		std::cerr << "offload: worker " << index << " priority, "
+				<< strerror(error) << "\n";
+
+	for (;;)
+	{
+		while ((sem_wait(&worker.wake) != 0) && (errno == EINTR))
+			;
+
+		if (!_running.load(std::memory_order_acquire))
+			return;
+
+		// one wake-up may cover several jobs, the extra posts find the queue empty.
+		while (const OffloadJob* job = worker.jobs.Front())
+		{
+			OffloadResult result;
+			std::memset(&result, 0, sizeof(result));
+			result.type = job->type;
+			result.id = job->id;
+			result.postTime = job->postTime;
+
+			WorkHandler work =
+					((job->type >= 0) && (job->type < MAX_TYPES)) ?
+							_work[job->type] : nullptr;
+			if (work)
+				work(*job, result);
+			else
+				result.status = -1;
+
+			worker.jobs.Pop();
+			result.doneTime = Now();
+
+			// the RT side is not polling, wait instead of losing the result.
+			while (!worker.results.Push(result))
+			{
+				if (!_running.load(std::memory_order_acquire))
+					return;
+				sched_yield();
+			}
+		}
+	}
+}
+
+bool OffloadPool::Post(OffloadJob& job)
+{
+	if (!_running.load(std::memory_order_relaxed))
+		return false;
+
+	job.id = ++_nextId;
+	job.postTime = Now();
+
+	for (int n = 0; n < _workerCount; ++n)
+	{
+		int i = _nextWorker;
+		if (++_nextWorker >= _workerCount)
+			_nextWorker = 0;
+
+		if (_workers[i].jobs.Push(job))
+		{
+			sem_post(&_workers[i].wake);
+			_posted.fetch_add(1, std::memory_order_relaxed);
+			return true;
+		}
+	}
+
+	_dropped.fetch_add(1, std::memory_order_relaxed);
+
+	return false;
+}
+
+bool OffloadPool::Poll(OffloadResult& result)
+{
+	for (int n = 0; n < _workerCount; ++n)
+	{
+		int i = _pollWorker;
+		if (++_pollWorker >= _workerCount)
+			_pollWorker = 0;
+
+		if (_workers[i].results.Pop(result))
+			return true;
+	}
+
+	return false;
+}
+
+int OffloadPool::Dispatch(void)
+{
+	OffloadResult result;
+	int count = 0;
+
+	while (Poll(result))
+	{
+		if ((result.type >= 0) && (result.type < MAX_TYPES) && _done[result.type])
+			_done[result.type](result);
+		++count;
+	}
+
+	return count;
+}
+
+OffloadPool::BenchStats OffloadPool::Benchmark(long periodNs, int jobs)
+{
+	BenchStats stats;
+	std::memset(&stats, 0, sizeof(stats));
+	stats.jobs = jobs;
+
+	double postSum = 0.0, pollSum = 0.0, doneSum = 0.0, seenSum = 0.0;
+	int polls = 0, results = 0;
+	struct timespec next;
+
+	clock_gettime(CLOCK_MONOTONIC, &next);
+
+	// a few more periods at the end to collect the last results
+	for (int k = 0; k < jobs + 100; ++k)
+	{
+		next.tv_nsec += periodNs;
+		while (next.tv_nsec >= 1000000000L)
+		{
+			next.tv_nsec -= 1000000000L;
+			++next.tv_sec;
+		}
+		clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+
+		if (k < jobs)
+		{
+			OffloadJob job;
+			std::memset(&job, 0, sizeof(job));
+			job.type = ECHO;
+			job.arg[0] = k;
+
+			int64_t t0 = Now();
+			Post(job);
+			int64_t post = Now() - t0;
+
+			postSum += post;
+			if (post > stats.postMaxNs)
+				stats.postMaxNs = post;
+		}
+
+		OffloadResult result;
+		for (;;)
+		{
+			int64_t t0 = Now();
+			bool found = Poll(result);
+			int64_t t1 = Now();
+
+			pollSum += t1 - t0;
+			++polls;
+			if (t1 - t0 > stats.pollMaxNs)
+				stats.pollMaxNs = t1 - t0;
+
+			if (!found)
+				break;
+
+			int64_t done = result.doneTime - result.postTime;
+			int64_t seen = t1 - result.postTime;
+
+			doneSum += done;
+			seenSum += seen;
+			++results;
+			if (done > stats.doneMaxNs)
+				stats.doneMaxNs = done;
+			if (seen > stats.seenMaxNs)
+				stats.seenMaxNs = seen;
+		}
+	}
+
+	stats.lost = jobs - results;
+	stats.postAvgNs = jobs ? postSum / jobs : 0.0;
+	stats.pollAvgNs = polls ? pollSum / polls : 0.0;
+	stats.doneAvgNs = results ? doneSum / results : 0.0;
+	stats.seenAvgNs = results ? seenSum / results : 0.0;
+
+	return stats;
+}
+
+void OffloadPool::Print(const BenchStats& stats)
+{
+	std::cout << "offload benchmark: " << stats.jobs << " jobs, " << stats.lost
+			<< " lost\n" << "  Post()          avg " << stats.postAvgNs / 1000.0
+			<< " us, max " << stats.postMaxNs / 1000.0 << " us\n"
+			<< "  Poll()          avg " << stats.pollAvgNs / 1000.0 << " us, max "
+			<< stats.pollMaxNs / 1000.0 << " us\n" << "  post -> done    avg "
+			<< stats.doneAvgNs / 1000.0 << " us, max " << stats.doneMaxNs / 1000.0
+			<< " us\n" << "  post -> polled  avg " << stats.seenAvgNs / 1000.0
+			<< " us, max " << stats.seenMaxNs / 1000.0 << " us\n";
+}
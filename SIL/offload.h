@@ -0,0 +1,184 @@
+/*
+ * offload.h
+ *
+ * Created on: Oct 19, 2026
+ * Author: RockyLiu
+ *
+ * Offload of heavy computations (FFT of a captured block, filter or model
+ * re-design...) from the RT callback to a pool of worker threads.
+ *
+ * Every worker owns one SpscQueue of jobs (RT -> worker) and one of results
+ * (worker -> RT), all preallocated, jobs and results are fixed-size
+ * descriptors copied by value. Post() puts the job in the queue of the next
+ * worker with room (round robin) and wakes it with sem_post(), which does
+ * not block and only enters the kernel when the worker is asleep. Poll() /
+ * Dispatch() pick the results up without blocking, typically from a slow
+ * task of the cyclic executive.
+ *
+ * Post(), Poll() and Dispatch() must all be called from one thread, the RT
+ * callback (or Benchmark() before the sync timer is created).
+ *
+ * Job types are registered before Start() with the worker-side handler and
+ * an optional RT-side one called by Dispatch() for each result. Type ECHO
+ * is built in, its result holds the job arguments, used by Benchmark().
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <semaphore.h>
+#include <system_error>
+#include <thread>
+#include "spsc_queue.h"
+
+struct OffloadJob
+{
+	int type;
+	uint32_t id;			// set by Post()
+	int64_t postTime;		// ns, CLOCK_MONOTONIC, set by Post()
+	const void* data;		// caller buffer, must stay untouched until the result is back
+	int length;
+	double arg[8];
+};
+
+struct OffloadResult
+{
+	int type;
+	uint32_t id;			// of the job
+	int64_t postTime;		// ns, of the job
+	int64_t doneTime;		// ns, when the worker finished it
+	int status;				// 0 -> ok, -1 -> no handler, others set by the handler
+	double value[8];
+};
+
+class OffloadPool
+{
+public:
+	static constexpr int MAX_WORKERS = 4;
+	static constexpr int QUEUE_DEPTH = 64;	// per worker
+	static constexpr int MAX_TYPES = 16;
+	static constexpr int ECHO = 0;
+
+	typedef void (*WorkHandler)(const OffloadJob& job, OffloadResult& result);
+	typedef void (*DoneHandler)(const OffloadResult& result);
+
+	struct WorkerParams
+	{
+		int workers = 1;
+		unsigned long cpuMask = 0;	// bit per CPU, 0 -> inherited
+		int priority = 0;			// SCHED_FIFO priority, 0 -> SCHED_OTHER
+	};
+
+	struct BenchStats
+	{
+		int jobs;
+		int lost;				// not posted (queues full) or no result in time
+		double postAvgNs;
+		long postMaxNs;
+		double pollAvgNs;		// Poll() call, empty or not
+		long pollMaxNs;
+		double doneAvgNs;		// post -> worker done
+		long doneMaxNs;
+		double seenAvgNs;		// post -> result polled by the posting thread
+		long seenMaxNs;
+	};
+
+	OffloadPool();
+	~OffloadPool();
+
+	OffloadPool(const OffloadPool&) = delete;
+	OffloadPool&
+	operator=(const OffloadPool&) = delete;
+
+	/*
+	 * Non-RT, before Start(): handlers of job type 'type' in [1, MAX_TYPES).
+	 */
+	bool
+	Register(int type, WorkHandler work, DoneHandler done = nullptr);
+
+	/*
+	 * Non-RT: start the workers, false if they are running already or a
+	 * thread could not be created. A failing affinity / priority is only reported.
+	 */
+	bool
+	Start(const WorkerParams& params);
+
+	/*
+	 * Non-RT: stop and join the workers, jobs still queued are dropped.
+	 */
+	void
+	Stop(void);
+
+	/*
+	 * RT: queue a job, false when all worker queues are full.
+	 */
+	bool
+	Post(OffloadJob& job);
+
+	/*
+	 * RT: one finished job, false when there is none.
+	 */
+	bool
+	Poll(OffloadResult& result);
+
+	/*
+	 * RT: poll all finished jobs and call their done handler, returns how many.
+	 */
+	int
+	Dispatch(void);
+
+	uint64_t
+	GetPosted(void) const
+	{
+		return _posted.load(std::memory_order_relaxed);
+	}
+
+	uint64_t
+	GetDropped(void) const
+	{
+		return _dropped.load(std::memory_order_relaxed);
+	}
+
+	/*
+	 * Non-RT benchmark, before the sync timer is created: post 'jobs' ECHO
+	 * jobs from the calling thread every 'periodNs' and poll the results
+	 * like the RT callback would, measuring its cost and the latencies.
+	 */
+	BenchStats
+	Benchmark(long periodNs, int jobs);
+
+	static void
+	Print(const BenchStats& stats);
+
+private:
+	struct Worker
+	{
+		SpscQueue<OffloadJob, QUEUE_DEPTH> jobs;
+		SpscQueue<OffloadResult, QUEUE_DEPTH> results;
+		sem_t wake;
+		std::thread thread;
+	};
+
+	static int64_t
+	Now(void);
+
+	void
+	Work(int index);
+
+	WorkerParams _params;
+	WorkHandler _work[MAX_TYPES];
+	DoneHandler _done[MAX_TYPES];
+
+	Worker _workers[MAX_WORKERS];
+	int _workerCount;
+	std::atomic<bool> _running;
+
+	// posting thread only
+	uint32_t _nextId;
+	int _nextWorker;
+	int _pollWorker;
+
+	std::atomic<uint64_t> _posted;
+	std::atomic<uint64_t> _dropped;
+};
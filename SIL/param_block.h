@@ -0,0 +1,121 @@
+/*
+ * param_block.h
+ *
+ * Created on: Oct 19, 2026
+ * Author: RockyLiu
+ *
+ * Sequence-lock protected parameter block.
+ *
+ * One non-RT writer (Modbus loop) publishes a complete set of tunables, the
+ * RT callback copies it out without locks or syscalls. The copy is done word
+ * by word through relaxed atomics, so a torn read is detected by the sequence
+ * counter instead of being undefined behavior. When the writer is in the
+ * middle of an update, the reader just keeps its previous snapshot and tries
+ * again on the next sync cycle.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstring>
+#include <type_traits>
+
+template<typename T>
+class ParamBlock
+{
+	static_assert(std::is_trivially_copyable<T>::value,
+			"ParamBlock only supports trivially copyable parameter sets!");
+
+public:
+	explicit
+	ParamBlock(const T& init) :
+			_seq(0)
+	{
+		Store(init);
+	}
+	~ParamBlock() = default;
+
+	ParamBlock(const ParamBlock&) = delete;
+	ParamBlock&
+	operator=(const ParamBlock&) = delete;
+
+	/*
+	 * Writer side, non-RT only. Must not be called from more than one thread.
+	 * Returns the generation of the published set.
+	 */
+	unsigned int
+	Publish(const T& params)
+	{
+		unsigned int seq = _seq.load(std::memory_order_relaxed);
+
+		_seq.store(seq + 1, std::memory_order_relaxed);	// odd -> write in progress
+		std::atomic_thread_fence(std::memory_order_release);
+
+		Store(params);
+
+		_seq.store(seq + 2, std::memory_order_release);
+
+		return (seq + 2) >> 1;
+	}
+
+	/*
+	 * Reader side, RT safe. Copies the block into 'out' only if a consistent
+	 * set newer than 'generation' is available, and updates 'generation'.
+	 * Returns false if nothing changed or the writer is busy.
+	 */
+	bool
+	TryRead(T& out, unsigned int& generation) const
+	{
+		unsigned int seq = _seq.load(std::memory_order_acquire);
+
+		if ((seq & 1) || ((seq >> 1) == generation))
+			return false;
+
+		T tmp;
+		Load(tmp);
+
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (_seq.load(std::memory_order_relaxed) != seq)
+			return false;
+
+		out = tmp;
+		generation = seq >> 1;
+
+		return true;
+	}
+
+	unsigned int
+	Generation() const
+	{
+		return _seq.load(std::memory_order_acquire) >> 1;
+	}
+
+private:
+	static constexpr unsigned int WORDS = (sizeof(T) + sizeof(unsigned int) - 1)
+			/ sizeof(unsigned int);
+
+	void
+	Store(const T& params)
+	{
+		unsigned int buffer[WORDS] =
+		{ 0 };
+		std::memcpy(buffer, &params, sizeof(T));
+
+		for (unsigned int i = 0; i < WORDS; ++i)
+			_data[i].store(buffer[i], std::memory_order_relaxed);
+	}
+
+	void
+	Load(T& params) const
+	{
+		unsigned int buffer[WORDS];
+
+		for (unsigned int i = 0; i < WORDS; ++i)
+			buffer[i] = _data[i].load(std::memory_order_relaxed);
+
+		std::memcpy(&params, buffer, sizeof(T));
+	}
+
+	std::atomic<unsigned int> _seq;
+	std::atomic<unsigned int> _data[WORDS];
+};
@@ -3,25 +3,447 @@
  *
  * Created on: Jul 25, 2022
  * Author: RockyLiu
+ *
+ * PIDController<Scalar, Policies...>
+ *
+ * Scalar	: double, float or QFormat<Frac> (see fixed_point.h).
+ * Policies	: at most one of each category, any order, defaults in brackets.
+ * 	integrator	-> [TrapezoidIntegrator], ForwardEulerIntegrator,
+ * 				   BackCalcIntegrator, NoIntegrator
+ * 	derivative	-> [RawDerivative], FilteredDerivative<CutoffHz>, NoDerivative
+ * 	ramp		-> [RampLimit], NoRamp
+ *
+ * PIDController<> has the same behavior as the former non-template class.
+ * Every policy lives in an empty base when unused, so a disabled feature
+ * adds neither state nor instructions, e.g. a P-only controller with ramp:
+ * 	PIDController<double, NoIntegrator, NoDerivative> pid {kp, 0, 0, ramp, limit, ts};
+ *
+ * Gains are set in double on the non-RT side, the sync cycle only runs
+ * Scalar arithmetic with the pre-multiplied coefficients.
  */
 
 #pragma once
 
+#include <type_traits>
+#include "fixed_point.h"
+
 #define _constrain(amt, low, high) ((amt)<(low)?(low):((amt)>(high)?(high):(amt)))
 
-class PIDController
+namespace PidPolicy
 {
+	struct IntegratorTag
+	{
+	};
+	struct DerivativeTag
+	{
+	};
+	struct RampTag
+	{
+	};
+
+	/*
+	 * Integrators, Integrate() returns the new integral term,
+	 * Saturated() is called with the output before/after limit & ramp.
+	 */
+	struct NoIntegrator
+	{
+		using Category = IntegratorTag;
+
+		template<typename Scalar>
+		class Impl
+		{
+		public:
+			Impl(double, double)
+			{
+			}
+			void SetKi(double)
+			{
+			}
+			Scalar Integrate(Scalar, Scalar)
+			{
+				return Scalar(0);
+			}
+			void Saturated(Scalar, Scalar)
+			{
+			}
+			void SetIntegral(Scalar)
+			{
+			}
+			Scalar GetIntegral() const
+			{
+				return Scalar(0);
+			}
+		};
+	};
+
+	struct TrapezoidIntegrator
+	{
+		using Category = IntegratorTag;
+
+		template<typename Scalar>
+		class Impl
+		{
+		public:
+			Impl(double ki, double ts) :
+					_ts(ts)
+			{
+				SetKi(ki);
+			}
+			void SetKi(double ki)
+			{
+				_kiTs = Scalar(ki * _ts * 0.5);
+			}
+			Scalar Integrate(Scalar error, Scalar limit)
+			{
+				Scalar integral = _integralPrev + _kiTs * (error + _errorPrev);
+				integral = _constrain(integral, -limit, limit);
+				_integralPrev = integral;
+				_errorPrev = error;
+				return integral;
+			}
+			void Saturated(Scalar, Scalar)
+			{
+			}
+			void SetIntegral(Scalar integral)
+			{
+				_integralPrev = integral;
+			}
+			Scalar GetIntegral() const
+			{
+				return _integralPrev;
+			}
+		private:
+			double _ts;
+			Scalar _kiTs;
+			Scalar _errorPrev = Scalar(0);
+			Scalar _integralPrev = Scalar(0);
+		};
+	};
+
+	struct ForwardEulerIntegrator
+	{
+		using Category = IntegratorTag;
+
+		template<typename Scalar>
+		class Impl
+		{
+		public:
+			Impl(double ki, double ts) :
+					_ts(ts)
+			{
+				SetKi(ki);
+			}
+			void SetKi(double ki)
+			{
+				_kiTs = Scalar(ki * _ts);
+			}
+			Scalar Integrate(Scalar error, Scalar limit)
+			{
+				Scalar integral = _integralPrev;
+				_integralPrev = _integralPrev + _kiTs * error;
+				_integralPrev = _constrain(_integralPrev, -limit, limit);
+				return integral;
+			}
+			void Saturated(Scalar, Scalar)
+			{
+			}
+			void SetIntegral(Scalar integral)
+			{
+				_integralPrev = integral;
+			}
+			Scalar GetIntegral() const
+			{
+				return _integralPrev;
+			}
+		private:
+			double _ts;
+			Scalar _kiTs;
+			Scalar _integralPrev = Scalar(0);
+		};
+	};
+
+	/*
+	 * Back-calculation anti-windup: the integral is not clamped, it is pulled
+	 * back by kb * (saturated output - unsaturated output). kb defaults to ki.
+	 */
+	struct BackCalcIntegrator
+	{
+		using Category = IntegratorTag;
+
+		template<typename Scalar>
+		class Impl
+		{
+		public:
+			Impl(double ki, double ts) :
+					_ts(ts)
+			{
+				SetKi(ki);
+				SetKb(ki);
+			}
+			void SetKi(double ki)
+			{
+				_kiTs = Scalar(ki * _ts);
+			}
+			void SetKb(double kb)
+			{
+				_kbTs = Scalar(kb * _ts);
+			}
+			Scalar Integrate(Scalar error, Scalar)
+			{
+				_integral = _integral + _kiTs * error;
+				return _integral;
+			}
+			void Saturated(Scalar unsaturated, Scalar saturated)
+			{
+				_integral = _integral + _kbTs * (saturated - unsaturated);
+			}
+			void SetIntegral(Scalar integral)
+			{
+				_integral = integral;
+			}
+			Scalar GetIntegral() const
+			{
+				return _integral;
+			}
+		private:
+			double _ts;
+			Scalar _kiTs;
+			Scalar _kbTs;
+			Scalar _integral = Scalar(0);
+		};
+	};
+
+	/*
+	 * Derivatives, Derive() returns the derivative term.
+	 */
+	struct NoDerivative
+	{
+		using Category = DerivativeTag;
+
+		template<typename Scalar>
+		class Impl
+		{
+		public:
+			Impl(double, double)
+			{
+			}
+			void SetKd(double)
+			{
+			}
+			Scalar Derive(Scalar)
+			{
+				return Scalar(0);
+			}
+		};
+	};
+
+	struct RawDerivative
+	{
+		using Category = DerivativeTag;
+
+		template<typename Scalar>
+		class Impl
+		{
+		public:
+			Impl(double kd, double ts) :
+					_ts(ts)
+			{
+				SetKd(kd);
+			}
+			void SetKd(double kd)
+			{
+				_kdTs = Scalar(kd / _ts);
+			}
+			Scalar Derive(Scalar error)
+			{
+				Scalar derivative = _kdTs * (error - _errorPrev);
+				_errorPrev = error;
+				return derivative;
+			}
+		private:
+			double _ts;
+			Scalar _kdTs;
+			Scalar _errorPrev = Scalar(0);
+		};
+	};
+
+	/*
+	 * First order low-pass filtered derivative, cut-off frequency in Hz.
+	 */
+	template<int CutoffHz = 100>
+	struct FilteredDerivative
+	{
+		static_assert(CutoffHz > 0, "derivative filter cut-off must be positive!");
+
+		using Category = DerivativeTag;
+
+		template<typename Scalar>
+		class Impl
+		{
+		public:
+			Impl(double kd, double ts) :
+					_ts(ts)
+			{
+				// alpha = ts / (tau + ts), tau = 1 / (2 * pi * fc)
+				double tau = 1.0 / (6.283185307179586 * CutoffHz);
+				_alpha = Scalar(ts / (tau + ts));
+				SetKd(kd);
+			}
+			void SetKd(double kd)
+			{
+				_kdTs = Scalar(kd / _ts);
+			}
+			Scalar Derive(Scalar error)
+			{
+				Scalar raw = _kdTs * (error - _errorPrev);
+				_errorPrev = error;
+				_derivative = _derivative + _alpha * (raw - _derivative);
+				return _derivative;
+			}
+		private:
+			double _ts;
+			Scalar _kdTs;
+			Scalar _alpha;
+			Scalar _errorPrev = Scalar(0);
+			Scalar _derivative = Scalar(0);
+		};
+	};
+
+	/*
+	 * Output ramp limiters, ramp in output unit per second.
+	 */
+	struct NoRamp
+	{
+		using Category = RampTag;
+
+		template<typename Scalar>
+		class Impl
+		{
+		public:
+			Impl(double, double)
+			{
+			}
+			Scalar Limit(Scalar output)
+			{
+				return output;
+			}
+		};
+	};
+
+	struct RampLimit
+	{
+		using Category = RampTag;
+
+		template<typename Scalar>
+		class Impl
+		{
+		public:
+			Impl(double ramp, double ts) :
+					_enable(ramp > 0), _step(ramp * ts)
+			{
+			}
+			Scalar Limit(Scalar output)
+			{
+				if (_enable)
+					output = _constrain(output, _outputPrev - _step, _outputPrev + _step);
+
+				_outputPrev = output;
+				return output;
+			}
+		private:
+			bool _enable;
+			Scalar _step;
+			Scalar _outputPrev = Scalar(0);
+		};
+	};
+
+	/*
+	 * Number of policies of a category in the pack.
+	 */
+	template<typename Tag, typename ... Policies>
+	struct Count
+	{
+		static constexpr int value = 0;
+	};
+
+	template<typename Tag, typename Policy, typename ... Policies>
+	struct Count<Tag, Policy, Policies...>
+	{
+		static constexpr int value = std::is_same<typename Policy::Category, Tag>::value
+				+ Count<Tag, Policies...>::value;
+	};
+
+	/*
+	 * Pick the policy of a category from the pack, or the default one.
+	 * An unknown policy or two of the same category do not compile.
+	 */
+	template<typename Tag, typename Default, typename ... Policies>
+	struct Select
+	{
+		using type = Default;
+	};
+
+	template<typename Tag, typename Default, typename Policy, typename ... Policies>
+	struct Select<Tag, Default, Policy, Policies...>
+	{
+		static_assert(std::is_same<typename Policy::Category, IntegratorTag>::value
+				|| std::is_same<typename Policy::Category, DerivativeTag>::value
+				|| std::is_same<typename Policy::Category, RampTag>::value,
+				"unknown PID policy category!");
+		static_assert(Count<Tag, Policy, Policies...>::value <= 1,
+				"more than one PID policy of the same category!");
+
+		using type = typename std::conditional<
+				std::is_same<typename Policy::Category, Tag>::value, Policy,
+				typename Select<Tag, Default, Policies...>::type>::type;
+	};
+}
+
+template<typename Scalar = double, typename ... Policies>
+class PIDController :
+		private PidPolicy::Select<PidPolicy::IntegratorTag,
+				PidPolicy::TrapezoidIntegrator, Policies...>::type::template Impl<Scalar>,
+		private PidPolicy::Select<PidPolicy::DerivativeTag,
+				PidPolicy::RawDerivative, Policies...>::type::template Impl<Scalar>,
+		private PidPolicy::Select<PidPolicy::RampTag,
+				PidPolicy::RampLimit, Policies...>::type::template Impl<Scalar>
+{
+	using Integrator = typename PidPolicy::Select<PidPolicy::IntegratorTag,
+			PidPolicy::TrapezoidIntegrator, Policies...>::type::template Impl<Scalar>;
+	using Derivative = typename PidPolicy::Select<PidPolicy::DerivativeTag,
+			PidPolicy::RawDerivative, Policies...>::type::template Impl<Scalar>;
+	using Ramp = typename PidPolicy::Select<PidPolicy::RampTag,
+			PidPolicy::RampLimit, Policies...>::type::template Impl<Scalar>;
+
 public:
 	explicit
-	PIDController(double, double, double, double, double, double);
+	PIDController(double kp, double ki, double kd, double ramp, double limit,
+			double ts = 0.00025) :
+			Integrator(ki, ts), Derivative(kd, ts), Ramp(ramp, ts), _kp(kp), _ki(
+					ki), _kpS(kp), _limit(limit)
+	{
+	}
 	~PIDController() = default;
 
 	PIDController(const PIDController&) = delete;
 	PIDController&
 	operator=(const PIDController&) = delete;
 
-	double
-	operator()(double error);
+	Scalar
+	operator()(Scalar error)
+	{
+		Scalar proportional = _kpS * error;
+		Scalar integral = Integrator::Integrate(error, _limit);
+		Scalar derivative = Derivative::Derive(error);
+
+		Scalar unsaturated = proportional + integral + derivative;
+		Scalar output = _constrain(unsaturated, -_limit, _limit);
+		output = Ramp::Limit(output);
+
+		Integrator::Saturated(unsaturated, output);
+
+		return output;
+	}
 
 	const double&
 	GetKp() const
@@ -31,6 +453,7 @@ public:
 	void SetKp(const double kp)
 	{
 		_kp = kp;
+		_kpS = Scalar(kp);
 	}
 
 	const double&
@@ -41,17 +464,27 @@ public:
 	void SetKi(const double ki)
 	{
 		_ki = ki;
+		Integrator::SetKi(ki);
+	}
+
+	void SetKd(const double kd)
+	{
+		Derivative::SetKd(kd);
 	}
 
 private:
 	double _kp;
 	double _ki;
-	double _kd;
-	double _outputRamp;
-	double _limit;
-	double _ts;
-
-	double _errorPrev;
-	double _outputPrev;
-	double _integralPrev;
+
+	Scalar _kpS;
+	Scalar _limit;
 };
+
+/**
+ * Configurations used by the SIL functions, instantiated once in pid.cpp.
+ */
+using PController = PIDController<double, PidPolicy::NoIntegrator, PidPolicy::NoDerivative>;
+
+extern template class PIDController<> ;
+extern template class PIDController<double, PidPolicy::NoIntegrator,
+		PidPolicy::NoDerivative> ;
@@ -0,0 +1,163 @@
+/*
+ * pid_bank.h
+ *
+ * Created on: Oct 19, 2026
+ * Author: RockyLiu
+ *
+ * Bank of N PID controllers kept in structure-of-arrays form.
+ *
+ * Same control law as PIDController (trapezoid integral, output limit and
+ * ramp), but all lanes are updated in one pass without branches, so the
+ * compiler can turn the loop into SIMD instructions. Gains are stored
+ * pre-multiplied by the sample time, which is done once in SetGains() and
+ * never in the sync cycle.
+ *
+ * Note: NEON on the ARMv7 Maestro only vectorizes float, use
+ * PIDBank<N, float> there when the precision is good enough.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <limits>
+
+template<int N, typename Scalar = double>
+class PIDBank
+{
+	static_assert(N >= 1, "PIDBank needs at least 1 controller!");
+
+public:
+	explicit
+	PIDBank(Scalar ts = 0.00025) :
+			_ts(ts)
+	{
+		for (int i = 0; i < N; ++i)
+		{
+			SetGains(i, 0, 0, 0, 0, 0);
+			_errorPrev[i] = 0;
+			_outputPrev[i] = 0;
+			_integralPrev[i] = 0;
+		}
+	}
+	~PIDBank() = default;
+
+	PIDBank(const PIDBank&) = delete;
+	PIDBank&
+	operator=(const PIDBank&) = delete;
+
+	/*
+	 * Set gains of one lane, arguments are the same as PIDController.
+	 * ramp <= 0 disables the ramp limiter of that lane.
+	 */
+	void
+	SetGains(int i, Scalar kp, Scalar ki, Scalar kd, Scalar ramp, Scalar limit)
+	{
+		_kp[i] = kp;
+		_kiTs[i] = ki * _ts * Scalar(0.5);
+		_kdTs[i] = kd / _ts;
+		_limit[i] = limit;
+		_rampStep[i] =
+				(ramp > 0) ? ramp * _ts : std::numeric_limits<Scalar>::max();
+	}
+
+	void
+	SetKp(int i, Scalar kp)
+	{
+		_kp[i] = kp;
+	}
+
+	void
+	SetKi(int i, Scalar ki)
+	{
+		_kiTs[i] = ki * _ts * Scalar(0.5);
+	}
+
+	void
+	SetKd(int i, Scalar kd)
+	{
+		_kdTs[i] = kd / _ts;
+	}
+
+	/*
+	 * RT: gains and limit of one lane for the next update, same units as
+	 * SetGains() (gain scheduling). The integral is kept as its share of the
+	 * output, so a ki change does not make it jump, and the step of the
+	 * proportional term on the last error is moved into it, so a kp change
+	 * does not either (bumpless). Lanes without integral take the step.
+	 */
+	void
+	Schedule(int i, Scalar kp, Scalar ki, Scalar kd, Scalar limit)
+	{
+		const Scalar transfer = (ki != 0) ? (_kp[i] - kp) * _errorPrev[i] : Scalar(0);
+		const Scalar integral = _integralPrev[i] + transfer;
+
+		_integralPrev[i] = std::min(std::max(integral, -limit), limit);
+		_kp[i] = kp;
+		_kiTs[i] = ki * _ts * Scalar(0.5);
+		_kdTs[i] = kd / _ts;
+		_limit[i] = limit;
+	}
+
+	void
+	Reset(void)
+	{
+		for (int i = 0; i < N; ++i)
+		{
+			_errorPrev[i] = 0;
+			_outputPrev[i] = 0;
+			_integralPrev[i] = 0;
+		}
+	}
+
+	/*
+	 * Update all lanes in one pass, error[] and output[] hold N values.
+	 */
+	void
+	operator()(const Scalar* __restrict error, Scalar* __restrict output)
+	{
+#if defined(__GNUC__)
+#pragma GCC ivdep
+#endif
+		for (int i = 0; i < N; ++i)
+		{
+			const Scalar e = error[i];
+			const Scalar limit = _limit[i];
+
+			Scalar integral = _integralPrev[i] + _kiTs[i] * (e + _errorPrev[i]);
+			integral = std::min(std::max(integral, -limit), limit);
+
+			Scalar out = _kp[i] * e + integral + _kdTs[i] * (e - _errorPrev[i]);
+			out = std::min(std::max(out, -limit), limit);
+
+			const Scalar lo = _outputPrev[i] - _rampStep[i];
+			const Scalar hi = _outputPrev[i] + _rampStep[i];
+			out = std::min(std::max(out, lo), hi);
+
+			_integralPrev[i] = integral;
+			_outputPrev[i] = out;
+			_errorPrev[i] = e;
+			output[i] = out;
+		}
+	}
+
+	const Scalar&
+	GetOutput(int i) const
+	{
+		return _outputPrev[i];
+	}
+
+private:
+	// gains, one cache line aligned array per field
+	alignas(64) Scalar _kp[N];
+	alignas(64) Scalar _kiTs[N];
+	alignas(64) Scalar _kdTs[N];
+	alignas(64) Scalar _limit[N];
+	alignas(64) Scalar _rampStep[N];
+
+	// states
+	alignas(64) Scalar _errorPrev[N];
+	alignas(64) Scalar _outputPrev[N];
+	alignas(64) Scalar _integralPrev[N];
+
+	Scalar _ts;
+};
@@ -0,0 +1,209 @@
+/*
+ * relay_autotune.cpp
+ *
+ * Created on: Oct 19, 2026
+ * Author: RockyLiu
+ */
+
+#include "relay_autotune.h"
+#include <cmath>
+
+RelayAutotune::RelayAutotune(double ts) :
+		_ts(ts), _state(STATE::Idle), _abort(false), _started(false), _hold(0.0), _output(
+				0.0), _errorPrev(0.0), _cycle(0), _timeoutCycles(0), _lastCrossing(
+				-1.0), _crossings(0), _max(0.0), _min(0.0), _periodSum(0.0), _swingSum(
+				0.0), _ultimateGain(0.0), _ultimatePeriod(0.0), _amplitude(0.0)
+{
+}
+
+bool RelayAutotune::Start(const AutotuneParams& params)
+{
+	if (_state.load(std::memory_order_acquire) == STATE::Running)
+		return false;
+
+	_params = params;
+	if (_params.settle < 1)
+		_params.settle = 1;
+	if (_params.periods < 1)
+		_params.periods = 1;
+
+	_started = false;
+	_cycle = 0;
+	_timeoutCycles = static_cast<long>(_params.timeout / _ts);
+	_lastCrossing = -1.0;
+	_crossings = 0;
+	_periodSum = 0.0;
+	_swingSum = 0.0;
+
+	_abort.store(false, std::memory_order_relaxed);
+	_state.store(STATE::Running, std::memory_order_release);
+
+	return true;
+}
+
+void RelayAutotune::Abort(void)
+{
+	if (_state.load(std::memory_order_acquire) == STATE::Running)
+		_abort.store(true, std::memory_order_release);
+}
+
+bool RelayAutotune::Reset(void)
+{
+	if (_state.load(std::memory_order_acquire) == STATE::Running)
+		return false;
+
+	_state.store(STATE::Idle, std::memory_order_relaxed);
+
+	return true;
+}
+
+void RelayAutotune::Finish(STATE state)
+{
+	_state.store(state, std::memory_order_release);
+}
+
+double RelayAutotune::Update(double error, double hold)
+{
+	if (_state.load(std::memory_order_relaxed) != STATE::Running)
+		return hold;
+
+	if (_abort.load(std::memory_order_acquire))
+	{
+		_abort.store(false, std::memory_order_relaxed);
+		Finish(STATE::Idle);
+		return hold;
+	}
+
+	if (!_started)
+	{
+		_started = true;
+		_hold = hold;
+		_output = hold + ((error >= 0.0) ? _params.amplitude : -_params.amplitude);
+		_errorPrev = error;
+		_max = _min = error;
+	}
+
+	// relay with hysteresis
+	if (error > _params.hysteresis)
+		_output = _hold + _params.amplitude;
+	else if (error < -_params.hysteresis)
+		_output = _hold - _params.amplitude;
+
+	if (error > _max)
+		_max = error;
+	if (error < _min)
+		_min = error;
+
+	// upward zero crossing, interpolated between the two samples
+	if ((_errorPrev < 0.0) && (error >= 0.0))
+	{
+		const double crossing = _cycle - 1 + _errorPrev / (_errorPrev - error);
+
+		if ((_lastCrossing >= 0.0) && (++_crossings > _params.settle))
+		{
+			_periodSum += crossing - _lastCrossing;
+			_swingSum += _max - _min;
+		}
+		_lastCrossing = crossing;
+		_max = _min = error;
+
+		if (_crossings >= _params.settle + _params.periods)
+		{
+			const double n = _params.periods;
+			const double a = 0.5 * _swingSum / n;
+			const double h = _params.hysteresis;
+
+			_ultimatePeriod = _periodSum / n * _ts;
+			_amplitude = a;
+			_ultimateGain =
+					(a > h) ?
+							4.0 * _params.amplitude
+									/ (3.1415926535897931 * std::sqrt(a * a - h * h)) :
+							0.0;
+
+			Finish((_ultimateGain > 0.0) ? STATE::Done : STATE::Failed);
+			_errorPrev = error;
+			return _hold;
+		}
+	}
+
+	_errorPrev = error;
+
+	if (++_cycle >= _timeoutCycles)
+	{
+		Finish(STATE::Failed);
+		return _hold;
+	}
+
+	return _output;
+}
+
+bool RelayAutotune::GetGains(TUNING rule, double& kp, double& ki, double& kd) const
+{
+	if (_state.load(std::memory_order_acquire) != STATE::Done)
+		return false;
+
+	const double ku = _ultimateGain;
+	const double pu = _ultimatePeriod;
+	double ti = 0.0, td = 0.0;
+
+	switch (rule)
+	{
+	case TUNING::ZieglerNicholsPI:
+		kp = 0.45 * ku;
+		ti = pu / 1.2;
+		break;
+	case TUNING::ZieglerNicholsPID:
+		kp = 0.6 * ku;
+		ti = pu / 2.0;
+		td = pu / 8.0;
+		break;
+	case TUNING::TyreusLuybenPI:
+		kp = ku / 3.2;
+		ti = 2.2 * pu;
+		break;
+	case TUNING::TyreusLuybenPID:
+		kp = ku / 2.2;
+		ti = 2.2 * pu;
+		td = pu / 6.3;
+		break;
+	case TUNING::SomeOvershootPID:
+		kp = ku / 3.0;
+		ti = pu / 2.0;
+		td = pu / 3.0;
+		break;
+	case TUNING::NoOvershootPID:
+		kp = 0.2 * ku;
+		ti = pu / 2.0;
+		td = pu / 3.0;
+		break;
+	default:
+		return false;
+	}
+
+	ki = (ti > 0.0) ? kp / ti : 0.0;
+	kd = kp * td;
+
+	return true;
+}
+
+const char* RelayAutotune::GetName(TUNING rule)
+{
+	switch (rule)
+	{
+	case TUNING::ZieglerNicholsPI:
+		return "Ziegler-Nichols PI";
+	case TUNING::ZieglerNicholsPID:
+		return "Ziegler-Nichols PID";
+	case TUNING::TyreusLuybenPI:
+		return "Tyreus-Luyben PI";
+	case TUNING::TyreusLuybenPID:
+		return "Tyreus-Luyben PID";
+	case TUNING::SomeOvershootPID:
+		return "some overshoot PID";
+	case TUNING::NoOvershootPID:
+		return "no overshoot PID";
+	}
+
+	return "unknown";
+}
@@ -0,0 +1,161 @@
+/*
+ * relay_autotune.h
+ *
+ * Created on: Oct 19, 2026
+ * Author: RockyLiu
+ *
+ * Relay feedback auto-tuning (Astrom-Hagglund) of one velocity loop.
+ *
+ * While running, the controller of the axis is replaced by a relay with
+ * hysteresis around the output it had when the experiment started:
+ * 	u = hold + amplitude	when the error > hysteresis
+ * 	u = hold - amplitude	when the error < -hysteresis
+ * which makes the loop oscillate at its ultimate period. The RT side times
+ * the upward zero crossings of the error (interpolated between samples) and
+ * tracks its peaks, after 'settle' periods it averages 'periods' of them:
+ * 	Pu = mean period,  a = mean (max - min) / 2
+ * 	Ku = 4 d / (pi sqrt(a^2 - hysteresis^2))
+ * Every cycle costs the same few comparisons, whatever the state.
+ *
+ * The gains are computed on the non-RT side by GetGains() from Ku / Pu and a
+ * tuning rule, and applied there as one parameter set.
+ */
+
+#pragma once
+
+#include <atomic>
+
+enum class TUNING
+{
+	ZieglerNicholsPI,
+	ZieglerNicholsPID,
+	TyreusLuybenPI,
+	TyreusLuybenPID,
+	SomeOvershootPID,
+	NoOvershootPID,
+};
+
+struct AutotuneParams
+{
+	double amplitude = 0.2;		// relay amplitude, output unit (torque)
+	double hysteresis = 20.0;	// error unit (counts/s)
+	int settle = 2;				// periods ignored first
+	int periods = 4;			// periods averaged
+	double timeout = 5.0;		// s
+};
+
+class RelayAutotune
+{
+public:
+	static constexpr int RULES = 6;	// number of TUNING
+
+	enum class STATE
+	{
+		Idle, Running, Done, Failed,
+	};
+
+	explicit
+	RelayAutotune(double ts = 0.00025);
+	~RelayAutotune() = default;
+
+	RelayAutotune(const RelayAutotune&) = delete;
+	RelayAutotune&
+	operator=(const RelayAutotune&) = delete;
+
+	/*
+	 * Non-RT: start an experiment, false if one is running.
+	 */
+	bool
+	Start(const AutotuneParams& params);
+
+	/*
+	 * Non-RT: abort a running experiment, the RT side goes idle on its next cycle.
+	 */
+	void
+	Abort(void);
+
+	/*
+	 * Non-RT: back to idle once the result is used, false while running.
+	 */
+	bool
+	Reset(void);
+
+	/*
+	 * RT: relay output for this cycle. 'error' = setpoint - measurement,
+	 * 'hold' = the output of the normal controller, latched as the center
+	 * of the relay on the first cycle. Returns 'hold' when not running.
+	 */
+	double
+	Update(double error, double hold);
+
+	STATE
+	GetState(void) const
+	{
+		return _state.load(std::memory_order_acquire);
+	}
+
+	bool
+	IsRunning(void) const
+	{
+		return _state.load(std::memory_order_relaxed) == STATE::Running;
+	}
+
+	/*
+	 * Non-RT, once done: ultimate gain / period and oscillation amplitude.
+	 */
+	double
+	GetUltimateGain(void) const
+	{
+		return _ultimateGain;
+	}
+
+	double
+	GetUltimatePeriod(void) const
+	{
+		return _ultimatePeriod;
+	}
+
+	double
+	GetAmplitude(void) const
+	{
+		return _amplitude;
+	}
+
+	/*
+	 * Non-RT, once done: parallel gains out = kp e + ki integral(e) + kd de/dt,
+	 * false if there is no result.
+	 */
+	bool
+	GetGains(TUNING rule, double& kp, double& ki, double& kd) const;
+
+	static const char*
+	GetName(TUNING rule);
+
+private:
+	void
+	Finish(STATE state);
+
+	double _ts;
+	AutotuneParams _params;
+	std::atomic<STATE> _state;
+	std::atomic<bool> _abort;
+
+	// RT only
+	bool _started;
+	double _hold;
+	double _output;
+	double _errorPrev;
+	long _cycle;
+	long _timeoutCycles;
+	double _lastCrossing;		// cycles, interpolated, < 0 -> none yet
+	int _crossings;
+	double _max;
+	double _min;
+	double _periodSum;
+	double _swingSum;
+
+	// results, published by the release store of the state
+	double _ultimateGain;
+	double _ultimatePeriod;		// s
+	double _amplitude;
+};
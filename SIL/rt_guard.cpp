@@ -0,0 +1,259 @@
+/*
+ * rt_guard.cpp
+ *
+ * Created on: Oct 19, 2026
+ * Author: RockyLiu
+ */
+
+#include "rt_guard.h"
+
+#if RT_GUARD
+
+#include <atomic>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <execinfo.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+extern "C"
+{
+	// glibc entry points of the real allocator
+	void* __libc_malloc(size_t size);
+	void* __libc_calloc(size_t count, size_t size);
+	void* __libc_realloc(void* ptr, size_t size);
+	void __libc_free(void* ptr);
+}
+
+namespace RtGuard
+{
+	namespace
+	{
+		constexpr int MAX_EVENTS = 32;
+		constexpr int MAX_FRAMES = 16;
+
+		struct Event
+		{
+			HIT kind;
+			const char* what;
+			const char* scope;
+			int frameCount;
+			void* frames[MAX_FRAMES];
+		};
+
+		__thread int depth = 0;
+		__thread bool inHook = false;	// no recursion when backtrace() itself allocates
+		__thread const char* scopeName = nullptr;
+
+		std::atomic<unsigned long> hits[3];
+		std::atomic<int> eventCount(0);
+		Event events[MAX_EVENTS];
+	}
+
+	Scope::Scope(const char* name) :
+			_prevName(scopeName)
+	{
+		scopeName = name;
+		++depth;
+	}
+
+	Scope::~Scope()
+	{
+		--depth;
+		scopeName = _prevName;
+	}
+
+	void Init(void)
+	{
+		void* frames[2];
+		backtrace(frames, 2);
+	}
+
+	void Hit(HIT kind, const char* what)
+	{
+		if ((depth == 0) || inHook)
+			return;
+
+		inHook = true;
+
+		hits[static_cast<int>(kind)].fetch_add(1, std::memory_order_relaxed);
+
+		int index = eventCount.fetch_add(1, std::memory_order_relaxed);
+		if (index < MAX_EVENTS)
+		{
+			Event& event = events[index];
+			event.kind = kind;
+			event.what = what;
+			event.scope = scopeName;
+			event.frameCount = backtrace(event.frames, MAX_FRAMES);
+		}
+
+		inHook = false;
+	}
+
+	unsigned long GetHits(void)
+	{
+		return hits[0].load(std::memory_order_relaxed)
+				+ hits[1].load(std::memory_order_relaxed)
+				+ hits[2].load(std::memory_order_relaxed);
+	}
+
+	void Report(void)
+	{
+		int count = eventCount.load(std::memory_order_acquire);
+		if (count > MAX_EVENTS)
+			count = MAX_EVENTS;
+
+		fprintf(stderr,
+				"RT guard: %lu malloc, %lu free, %lu blocking calls inside RT scopes\n",
+				hits[0].load(), hits[1].load(), hits[2].load());
+
+		for (int i = 0; i < count; ++i)
+		{
+			const Event& event = events[i];
+			fprintf(stderr, "-- %s in RT scope <%s>:\n", event.what,
+					event.scope ? event.scope : "?");
+			backtrace_symbols_fd(event.frames, event.frameCount, STDERR_FILENO);
+		}
+	}
+}
+
+/*
+ * Allocator interposers, glibc allows replacing malloc when all of
+ * malloc / calloc / realloc / free are provided.
+ */
+extern "C"
+{
+	void* malloc(size_t size)
+	{
+		RtGuard::Hit(RtGuard::HIT::Malloc, "malloc");
+		return __libc_malloc(size);
+	}
+
+	void* calloc(size_t count, size_t size)
+	{
+		RtGuard::Hit(RtGuard::HIT::Malloc, "calloc");
+		return __libc_calloc(count, size);
+	}
+
+	void* realloc(void* ptr, size_t size)
+	{
+		RtGuard::Hit(RtGuard::HIT::Malloc, "realloc");
+		return __libc_realloc(ptr, size);
+	}
+
+	void free(void* ptr)
+	{
+		if (ptr)
+			RtGuard::Hit(RtGuard::HIT::Free, "free");
+		__libc_free(ptr);
+	}
+}
+
+#if RT_GUARD_SYSCALLS
+
+/*
+ * Blocking call wrappers, active with the --wrap linker options.
+ */
+extern "C"
+{
+	ssize_t __real_write(int fd, const void* buffer, size_t count);
+	ssize_t __real_read(int fd, void* buffer, size_t count);
+	int __real_usleep(useconds_t usec);
+	int __real_nanosleep(const struct timespec* req, struct timespec* rem);
+	int __real_pthread_mutex_lock(pthread_mutex_t* mutex);
+	int __real_printf(const char* format, ...);
+	int __real_puts(const char* str);
+	size_t __real_fwrite(const void* ptr, size_t size, size_t count, FILE* stream);
+
+	ssize_t __wrap_write(int fd, const void* buffer, size_t count)
+	{
+		RtGuard::Hit(RtGuard::HIT::Blocking, "write");
+		return __real_write(fd, buffer, count);
+	}
+
+	ssize_t __wrap_read(int fd, void* buffer, size_t count)
+	{
+		RtGuard::Hit(RtGuard::HIT::Blocking, "read");
+		return __real_read(fd, buffer, count);
+	}
+
+	int __wrap_usleep(useconds_t usec)
+	{
+		RtGuard::Hit(RtGuard::HIT::Blocking, "usleep");
+		return __real_usleep(usec);
+	}
+
+	int __wrap_nanosleep(const struct timespec* req, struct timespec* rem)
+	{
+		RtGuard::Hit(RtGuard::HIT::Blocking, "nanosleep");
+		return __real_nanosleep(req, rem);
+	}
+
+	int __wrap_pthread_mutex_lock(pthread_mutex_t* mutex)
+	{
+		RtGuard::Hit(RtGuard::HIT::Blocking, "pthread_mutex_lock");
+		return __real_pthread_mutex_lock(mutex);
+	}
+
+	int __wrap_printf(const char* format, ...)
+	{
+		RtGuard::Hit(RtGuard::HIT::Blocking, "printf");
+
+		va_list args;
+		va_start(args, format);
+		int result = vprintf(format, args);
+		va_end(args);
+
+		return result;
+	}
+
+	int __wrap_puts(const char* str)
+	{
+		RtGuard::Hit(RtGuard::HIT::Blocking, "puts");
+		return __real_puts(str);
+	}
+
+	size_t __wrap_fwrite(const void* ptr, size_t size, size_t count, FILE* stream)
+	{
+		RtGuard::Hit(RtGuard::HIT::Blocking, "fwrite");
+		return __real_fwrite(ptr, size, count, stream);
+	}
+}
+
+#endif // RT_GUARD_SYSCALLS
+
+#else
+
+namespace RtGuard
+{
+	Scope::Scope(const char*) :
+			_prevName(nullptr)
+	{
+	}
+
+	Scope::~Scope()
+	{
+	}
+
+	void Init(void)
+	{
+	}
+
+	void Hit(HIT, const char*)
+	{
+	}
+
+	unsigned long GetHits(void)
+	{
+		return 0;
+	}
+
+	void Report(void)
+	{
+	}
+}
+
+#endif // RT_GUARD
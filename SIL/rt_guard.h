@@ -0,0 +1,95 @@
+/*
+ * rt_guard.h
+ *
+ * Created on: Oct 19, 2026
+ * Author: RockyLiu
+ *
+ * Debug-build checker for hidden allocations and blocking calls in RT code.
+ *
+ * RT_SCOPE() marks the enclosing block as real-time through a thread local
+ * depth counter. With RT_GUARD=1, malloc / calloc / realloc / free (and so
+ * new / delete, which go through them) are interposed, every call made
+ * inside an RT scope is counted and its backtrace recorded in a fixed
+ * buffer. RtGuard::Report() prints them from the non-RT side.
+ *
+ * With RT_GUARD_SYSCALLS=1 the blocking calls below are checked as well,
+ * the program must then be linked with
+ * 	-Wl,--wrap=write,--wrap=read,--wrap=usleep,--wrap=nanosleep,
+ * 	    --wrap=pthread_mutex_lock,--wrap=printf,--wrap=puts,--wrap=fwrite
+ *
+ * RT_GUARD defaults to 1 in debug builds (no NDEBUG), RT_GUARD_SYSCALLS
+ * needs the link options above and stays 0 unless asked for. Release builds
+ * leave both at 0, RT_SCOPE() compiles to nothing.
+ */
+
+#pragma once
+
+#ifndef RT_GUARD
+#ifdef NDEBUG
+#define RT_GUARD			0
+#else
+#define RT_GUARD			1
+#endif
+#endif
+
+#ifndef RT_GUARD_SYSCALLS
+#define RT_GUARD_SYSCALLS	0
+#endif
+
+namespace RtGuard
+{
+	enum class HIT
+	{
+		Malloc, Free, Blocking,
+	};
+
+	/**
+	 * Scope marked as real-time, may be nested.
+	 */
+	class Scope
+	{
+	public:
+		explicit
+		Scope(const char* name);
+		~Scope();
+
+		Scope(const Scope&) = delete;
+		Scope&
+		operator=(const Scope&) = delete;
+
+	private:
+		const char* _prevName;
+	};
+
+	/*
+	 * Non-RT, before the first RT scope: preloads the unwinder so the
+	 * first recorded backtrace does not allocate itself.
+	 */
+	void
+	Init(void);
+
+	/*
+	 * Called by the interposers, counts and records the hit if the
+	 * calling thread is inside an RT scope.
+	 */
+	void
+	Hit(HIT kind, const char* what);
+
+	/*
+	 * Number of hits since start, all kinds.
+	 */
+	unsigned long
+	GetHits(void);
+
+	/*
+	 * Non-RT: print the counters and the recorded backtraces to stderr.
+	 */
+	void
+	Report(void);
+}
+
+#if RT_GUARD
+#define RT_SCOPE(name)	RtGuard::Scope rtScope(name)
+#else
+#define RT_SCOPE(name)
+#endif
@@ -0,0 +1,246 @@
+/*
+ * rt_process.cpp
+ *
+ * Created on: Oct 19, 2026
+ * Author: RockyLiu
+ */
+
+#include "rt_process.h"
+#include <alloca.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <malloc.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/prctl.h>
+#include <syslog.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace RtProcess
+{
+	namespace
+	{
+		unsigned long
+		ReadLockedKb(void)
+		{
+			unsigned long kb = 0;
+			char line[128];
+			FILE* status = fopen("/proc/self/status", "r");
+
+			if (!status)
+				return 0;
+
+			while (fgets(line, sizeof(line), status))
+			{
+				if (sscanf(line, "VmLck: %lu kB", &kb) == 1)
+					break;
+			}
+			fclose(status);
+
+			return kb;
+		}
+
+		bool
+		PrefaultHeap(std::size_t size)
+		{
+			// keep freed memory in the heap instead of giving it back to the kernel,
+			// and serve every block from the heap, not from a fresh mmap.
+			if (!mallopt(M_TRIM_THRESHOLD, -1) || !mallopt(M_MMAP_MAX, 0))
+				return false;
+
+			char* buffer = static_cast<char*>(malloc(size));
+			if (!buffer)
+				return false;
+
+			long page = sysconf(_SC_PAGESIZE);
+			for (std::size_t i = 0; i < size; i += page)
+				buffer[i] = 0;
+
+			free(buffer);
+
+			return true;
+		}
+
+		bool
+		PrefaultStack(std::size_t size)
+		{
+			volatile char* buffer = static_cast<volatile char*>(alloca(size));
+
+			long page = sysconf(_SC_PAGESIZE);
+			for (std::size_t i = 0; i < size; i += page)
+				buffer[i] = 0;
+
+			return true;
+		}
+
+		bool
+		SetThread(int policy, int priority, unsigned long cpuMask,
+				RtReport& report)
+		{
+			const pthread_t self = pthread_self();
+
+			if (cpuMask)
+			{
+				cpu_set_t set;
+				CPU_ZERO(&set);
+				for (unsigned int cpu = 0; cpu < 8 * sizeof(cpuMask); ++cpu)
+				{
+					if (cpuMask & (1UL << cpu))
+						CPU_SET(cpu, &set);
+				}
+				pthread_setaffinity_np(self, sizeof(set), &set);
+			}
+
+			report.cpuMask = 0;
+			cpu_set_t actual;
+			CPU_ZERO(&actual);
+			if (pthread_getaffinity_np(self, sizeof(actual), &actual) == 0)
+			{
+				for (unsigned int cpu = 0; cpu < 8 * sizeof(report.cpuMask); ++cpu)
+				{
+					if (CPU_ISSET(cpu, &actual))
+						report.cpuMask |= (1UL << cpu);
+				}
+			}
+			report.affinityOk = !cpuMask || (report.cpuMask == cpuMask);
+
+			struct sched_param param;
+			memset(&param, 0, sizeof(param));
+			param.sched_priority = priority;
+			pthread_setschedparam(self, policy, &param);
+
+			if (pthread_getschedparam(self, &report.policy, &param) == 0)
+				report.priority = param.sched_priority;
+			report.policyOk = (report.policy == policy)
+					&& (report.priority == priority);
+
+			return report.policyOk && report.affinityOk;
+		}
+
+		long
+		Diff(const struct timespec& a, const struct timespec& b)
+		{
+			return (a.tv_sec - b.tv_sec) * 1000000000L + (a.tv_nsec - b.tv_nsec);
+		}
+	}
+
+	bool ApplyProcess(const RtProfile& profile, RtReport& report)
+	{
+		memset(&report, 0, sizeof(report));
+
+		// memory first, so the rest runs on locked pages
+		if (profile.lockMemory)
+		{
+			report.memoryLockOk = (mlockall(MCL_CURRENT | MCL_FUTURE) == 0);
+			report.heapOk = PrefaultHeap(profile.heapReserve);
+			report.stackOk = PrefaultStack(profile.stackReserve);
+			report.lockedKb = ReadLockedKb();
+			report.memoryLockOk = report.memoryLockOk && (report.lockedKb > 0);
+		}
+		else
+		{
+			report.memoryLockOk = report.heapOk = report.stackOk = true;
+		}
+
+#ifdef PR_SET_THP_DISABLE
+		if (profile.disableThp)
+			report.thpOk = (prctl(PR_SET_THP_DISABLE, 1, 0, 0, 0) == 0)
+					&& (prctl(PR_GET_THP_DISABLE, 0, 0, 0, 0) == 1);
+		else
+			report.thpOk = true;
+#else
+		report.thpOk = !profile.disableThp;
+#endif
+
+		return report.memoryLockOk && report.heapOk && report.stackOk
+				&& report.thpOk;
+	}
+
+	bool ApplyThread(const RtProfile& profile, RtReport& report)
+	{
+		return SetThread(profile.policy, profile.priority, profile.cpuMask,
+				report);
+	}
+
+	bool ResetThread(unsigned long cpuMask)
+	{
+		RtReport report;
+		memset(&report, 0, sizeof(report));
+
+		return SetThread(SCHED_OTHER, 0, cpuMask, report);
+	}
+
+	void Print(const RtReport& report)
+	{
+		const char* policy =
+				(report.policy == SCHED_FIFO) ? "SCHED_FIFO" :
+				(report.policy == SCHED_RR) ? "SCHED_RR" : "SCHED_OTHER";
+
+		std::cout << "RT profile:\n" << "  scheduling : " << policy << " "
+				<< report.priority << (report.policyOk ? "" : "  [FAILED]") << "\n"
+				<< "  affinity   : 0x" << std::hex << report.cpuMask << std::dec
+				<< (report.affinityOk ? "" : "  [FAILED]") << "\n"
+				<< "  mlockall   : " << report.lockedKb << " kB locked"
+				<< (report.memoryLockOk ? "" : "  [FAILED]") << "\n"
+				<< "  prefault   : heap " << (report.heapOk ? "ok" : "[FAILED]")
+				<< ", stack " << (report.stackOk ? "ok" : "[FAILED]") << "\n"
+				<< "  THP        : " << (report.thpOk ? "disabled" : "[FAILED]")
+				<< "\n";
+
+		syslog(LOG_INFO,
+				"RT profile: %s %d%s, affinity 0x%lx%s, %lu kB locked%s, prefault heap %s stack %s, THP %s\n",
+				policy, report.priority, report.policyOk ? "" : " FAILED",
+				report.cpuMask, report.affinityOk ? "" : " FAILED", report.lockedKb,
+				report.memoryLockOk ? "" : " FAILED", report.heapOk ? "ok" : "FAILED",
+				report.stackOk ? "ok" : "FAILED", report.thpOk ? "disabled" : "FAILED");
+	}
+
+	JitterStats MeasureJitter(long periodNs, int cycles)
+	{
+		JitterStats stats =
+		{ 0, 0, 0.0, 0, 0 };
+		struct timespec next, now;
+		double sum = 0.0;
+
+		clock_gettime(CLOCK_MONOTONIC, &next);
+
+		for (int i = 0; i < cycles; ++i)
+		{
+			next.tv_nsec += periodNs;
+			while (next.tv_nsec >= 1000000000L)
+			{
+				next.tv_nsec -= 1000000000L;
+				++next.tv_sec;
+			}
+
+			clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+			clock_gettime(CLOCK_MONOTONIC, &now);
+
+			long latency = Diff(now, next);
+
+			if ((i == 0) || (latency < stats.minNs))
+				stats.minNs = latency;
+			if ((i == 0) || (latency > stats.maxNs))
+				stats.maxNs = latency;
+			if (latency > 50000)
+				++stats.over50us;
+			sum += latency;
+		}
+
+		stats.cycles = cycles;
+		stats.avgNs = cycles ? sum / cycles : 0.0;
+
+		return stats;
+	}
+
+	void Print(const char* title, const JitterStats& stats)
+	{
+		std::cout << title << ": " << stats.cycles << " cycles, latency min "
+				<< stats.minNs / 1000.0 << " us, avg " << stats.avgNs / 1000.0
+				<< " us, max " << stats.maxNs / 1000.0 << " us, > 50us: "
+				<< stats.over50us << "\n";
+	}
+}
@@ -0,0 +1,112 @@
+/*
+ * rt_process.h
+ *
+ * Created on: Oct 19, 2026
+ * Author: RockyLiu
+ *
+ * Real-time bring-up, in two parts:
+ *  - ApplyProcess(): memory locking, prefault and THP, process-wide, at the
+ *    very beginning of main() so the locked memory covers everything
+ *    allocated later.
+ *  - ApplyThread(): scheduling policy and CPU affinity of the calling thread
+ *    only. Threads created by it inherit both, so it is applied right before
+ *    the SYNC timer is created and the creating thread then goes back to
+ *    SCHED_OTHER on the housekeeping CPUs with ResetThread(). Modbus loop,
+ *    file writers and the other non-RT threads never run SCHED_FIFO on the
+ *    RT CPUs.
+ *
+ * Every setting is read back after it was applied and reported, a failing
+ * setting does not stop the others (e.g. no CAP_SYS_NICE on a host PC).
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <sched.h>
+
+namespace RtProcess
+{
+	/**
+	 * Declared RT profile.
+	 */
+	struct RtProfile
+	{
+		int policy = SCHED_FIFO;
+		int priority = 40;					// below the SYNC user callback
+		unsigned long cpuMask = 0;			// bit per CPU, 0 -> keep the current affinity
+		bool lockMemory = true;				// mlockall(MCL_CURRENT | MCL_FUTURE)
+		std::size_t heapReserve = 8 << 20;	// bytes prefaulted and kept in the heap
+		std::size_t stackReserve = 256 << 10;	// bytes of main thread stack prefaulted
+		bool disableThp = true;				// no transparent huge pages for the process
+	};
+
+	/**
+	 * What was actually applied, read back from the kernel.
+	 */
+	struct RtReport
+	{
+		bool policyOk;
+		int policy;
+		int priority;
+
+		bool affinityOk;
+		unsigned long cpuMask;
+
+		bool memoryLockOk;
+		unsigned long lockedKb;			// VmLck of /proc/self/status
+
+		bool heapOk;
+		bool stackOk;
+
+		bool thpOk;
+	};
+
+	/**
+	 * Wake-up latency of a periodic clock_nanosleep loop.
+	 */
+	struct JitterStats
+	{
+		long minNs;
+		long maxNs;
+		double avgNs;
+		long over50us;	// cycles later than 50us
+		int cycles;
+	};
+
+	/*
+	 * Memory and THP part of the profile, for the whole process. Clears
+	 * 'report', true if every requested setting was verified.
+	 */
+	bool
+	ApplyProcess(const RtProfile& profile, RtReport& report);
+
+	/*
+	 * Policy, priority and affinity part of the profile, for the calling
+	 * thread and the threads it creates afterwards. Fills the scheduling
+	 * fields of 'report', true if they were verified.
+	 */
+	bool
+	ApplyThread(const RtProfile& profile, RtReport& report);
+
+	/*
+	 * Calling thread back to SCHED_OTHER on 'cpuMask' (0 -> keep the
+	 * affinity), true if verified.
+	 */
+	bool
+	ResetThread(unsigned long cpuMask);
+
+	/*
+	 * Print the report to stdout and syslog.
+	 */
+	void
+	Print(const RtReport& report);
+
+	/*
+	 * Benchmark: run 'cycles' periodic wake-ups on the calling thread.
+	 */
+	JitterStats
+	MeasureJitter(long periodNs, int cycles);
+
+	void
+	Print(const char* title, const JitterStats& stats);
+}
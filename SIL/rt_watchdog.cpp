@@ -0,0 +1,100 @@
+/*
+ * rt_watchdog.cpp
+ *
+ * Created on: Oct 19, 2026
+ * Author: RockyLiu
+ */
+
+#include "rt_watchdog.h"
+#include <iostream>
+#include <syslog.h>
+
+RtWatchdog::RtWatchdog(ModeManager& modeManager, int64_t deadlineNs,
+		int escalateAfter) :
+		_modeManager(modeManager), _deadline(deadlineNs), _escalateAfter(
+				escalateAfter), _fallback
+		{ nullptr, nullptr, nullptr }, _start(0), _consecutive(0), _cycles(0), _overruns(
+				0), _escalated(false), _worst(), _worstBlock(WorstTable())
+{
+}
+
+void RtWatchdog::End(void)
+{
+	int64_t duration = Now() - _start;
+
+	_cycles.fetch_add(1, std::memory_order_relaxed);
+
+	if (duration <= _deadline)
+	{
+		_consecutive = 0;
+		return;
+	}
+
+	_overruns.fetch_add(1, std::memory_order_relaxed);
+	Remember(duration);
+
+	if ((++_consecutive >= _escalateAfter)
+			&& !_escalated.load(std::memory_order_relaxed))
+	{
+		// takes effect on the next cycle, refused during a mode switch, tried
+		// again on the next overrun.
+		if (_modeManager.Override(
+				_fallback[static_cast<int>(_modeManager.GetMotionMode())]))
+			_escalated.store(true, std::memory_order_release);
+	}
+}
+
+void RtWatchdog::Remember(int64_t duration)
+{
+	// the table is sorted, only cycles worse than the last entry get in.
+	if (duration <= _worst.record[WORST_COUNT - 1].duration)
+		return;
+
+	int i = WORST_COUNT - 1;
+	for (; (i > 0) && (_worst.record[i - 1].duration < duration); --i)
+		_worst.record[i] = _worst.record[i - 1];
+
+	_worst.record[i].duration = duration;
+	_worst.record[i].timestamp = _start;
+	_worst.record[i].cycle = _cycles.load(std::memory_order_relaxed);
+	_worst.record[i].funcIndex = _modeManager.GetIndex();
+
+	_worstBlock.Publish(_worst);
+}
+
+void RtWatchdog::Report(void) const
+{
+	WorstTable worst;
+	unsigned int generation = 0;
+
+	// rarely busy, the RT side only publishes when a new worst cycle shows up.
+	while (_worstBlock.Generation() != 0 && !_worstBlock.TryRead(worst, generation))
+		;
+
+	uint64_t cycles = GetCycles();
+	uint64_t overruns = GetOverruns();
+
+	std::cout << "RT watchdog: " << overruns << " overruns in " << cycles
+			<< " cycles, deadline " << _deadline / 1000 << " us"
+			<< (IsEscalated() ? ", escalated to fallback\n" : "\n");
+	syslog(LOG_INFO, "RT watchdog: %llu overruns in %llu cycles%s\n",
+			static_cast<unsigned long long>(overruns),
+			static_cast<unsigned long long>(cycles),
+			IsEscalated() ? ", escalated to fallback" : "");
+
+	if (generation == 0)
+		return;
+
+	for (int i = 0; i < WORST_COUNT; ++i)
+	{
+		const Record& record = worst.record[i];
+		if (record.duration == 0)
+			break;
+
+		std::cout << "  " << record.duration / 1000 << " us at "
+				<< record.timestamp / 1000000 << " ms (cycle " << record.cycle
+				<< ", " << ((record.funcIndex >= 0) ?
+						_modeManager.GetEntry(record.funcIndex).name : "none")
+				<< ")\n";
+	}
+}
@@ -0,0 +1,132 @@
+/*
+ * rt_watchdog.h
+ *
+ * Created on: Oct 19, 2026
+ * Author: RockyLiu
+ *
+ * Deadline monitor around the SYNC timer callback.
+ *
+ * Begin() / End() bracket every cycle and read CLOCK_MONOTONIC (vDSO, no
+ * syscall). A cycle whose execution time exceeds the deadline is counted as
+ * an overrun, the worst ones are kept with their timestamp, and after
+ * 'escalateAfter' consecutive overruns the ModeManager slot is overridden by
+ * the fallback registered for the current motion mode (e.g. damping only).
+ * The watchdog stays escalated until Rearm() is called from the non-RT side.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <time.h>
+#include "mode_manager.h"
+#include "param_block.h"
+
+class RtWatchdog
+{
+public:
+	static constexpr int WORST_COUNT = 8;
+
+	struct Record
+	{
+		int64_t duration;	// ns
+		int64_t timestamp;	// ns, CLOCK_MONOTONIC at the start of the cycle
+		uint64_t cycle;
+		int funcIndex;		// ModeManager index running in that cycle
+	};
+
+	struct WorstTable
+	{
+		Record record[WORST_COUNT];	// sorted, longest first
+	};
+
+	RtWatchdog(ModeManager& modeManager, int64_t deadlineNs, int escalateAfter);
+	~RtWatchdog() = default;
+
+	RtWatchdog(const RtWatchdog&) = delete;
+	RtWatchdog&
+	operator=(const RtWatchdog&) = delete;
+
+	/*
+	 * Non-RT, before the timer starts: cheap function to run in 'mode'
+	 * when the watchdog escalates, nullptr -> stop writing commands.
+	 */
+	void
+	SetFallback(MOTIONMODE mode, SilFunc fallback)
+	{
+		_fallback[static_cast<int>(mode)] = fallback;
+	}
+
+	/*
+	 * RT: call first / last in the SYNC callback.
+	 */
+	void
+	Begin(void)
+	{
+		_start = Now();
+	}
+
+	void
+	End(void);
+
+	/*
+	 * Non-RT: leave the escalated state, e.g. after a new function was selected.
+	 */
+	void
+	Rearm(void)
+	{
+		_escalated.store(false, std::memory_order_release);
+	}
+
+	bool
+	IsEscalated(void) const
+	{
+		return _escalated.load(std::memory_order_acquire);
+	}
+
+	uint64_t
+	GetOverruns(void) const
+	{
+		return _overruns.load(std::memory_order_relaxed);
+	}
+
+	uint64_t
+	GetCycles(void) const
+	{
+		return _cycles.load(std::memory_order_relaxed);
+	}
+
+	/*
+	 * Non-RT: print counters and the worst cycles to stdout and syslog.
+	 */
+	void
+	Report(void) const;
+
+private:
+	static int64_t
+	Now(void)
+	{
+		struct timespec ts;
+		clock_gettime(CLOCK_MONOTONIC, &ts);
+		return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+	}
+
+	void
+	Remember(int64_t duration);
+
+	ModeManager& _modeManager;
+	int64_t _deadline;
+	int _escalateAfter;
+	SilFunc _fallback[3];
+
+	int64_t _start;
+	int _consecutive;
+
+	std::atomic<uint64_t> _cycles;
+	std::atomic<uint64_t> _overruns;
+	std::atomic<bool> _escalated;
+
+	// worst cycles, the RT side keeps its own copy and publishes it when it changes
+	WorstTable _worst;
+	ParamBlock<WorstTable> _worstBlock;
+};
@@ -0,0 +1,158 @@
+/*
+ * scope_capture.cpp
+ *
+ * Created on: Oct 19, 2026
+ * Author: RockyLiu
+ */
+
+#include "scope_capture.h"
+#include <cstdint>
+#include <fstream>
+
+ScopeCapture::ScopeCapture(double ts) :
+		_ts(ts), _state(STATE::Idle), _disarm(false), _length(0), _write(0), _filled(
+				0), _remaining(0), _phase(0), _cycle(0), _triggerCycle(0), _previous(
+				0.0)
+{
+}
+
+bool ScopeCapture::Arm(const ScopeParams& params)
+{
+	STATE state = _state.load(std::memory_order_acquire);
+	if ((state == STATE::Armed) || (state == STATE::Triggered))
+		return false;
+
+	_params = params;
+	if (_params.postTrigger < 1)
+		_params.postTrigger = 1;
+	if (_params.postTrigger > MAX_SAMPLES)
+		_params.postTrigger = MAX_SAMPLES;
+	if (_params.preTrigger < 0)
+		_params.preTrigger = 0;
+	if (_params.preTrigger > MAX_SAMPLES - _params.postTrigger)
+		_params.preTrigger = MAX_SAMPLES - _params.postTrigger;
+	if (_params.decimation < 1)
+		_params.decimation = 1;
+
+	_length = _params.preTrigger + _params.postTrigger;
+	_write = 0;
+	_filled = 0;
+	_remaining = 0;
+	_phase = 0;
+	_cycle = 0;
+	_triggerCycle = 0;
+	_previous = 0.0;
+
+	_disarm.store(false, std::memory_order_relaxed);
+	_state.store(STATE::Armed, std::memory_order_release);
+
+	return true;
+}
+
+void ScopeCapture::Disarm(void)
+{
+	STATE state = _state.load(std::memory_order_acquire);
+
+	if (state == STATE::Done)
+		_state.store(STATE::Idle, std::memory_order_release);
+	else if (state != STATE::Idle)
+		_disarm.store(true, std::memory_order_release);
+}
+
+bool ScopeCapture::IsTriggered(double value) const
+{
+	switch (_params.trigger)
+	{
+	case TRIGGER::Level:
+		return value >= _params.level;
+	case TRIGGER::Rising:
+		return (_previous < _params.level) && (value >= _params.level);
+	case TRIGGER::Falling:
+		return (_previous > _params.level) && (value <= _params.level);
+	case TRIGGER::Mask:
+		return (static_cast<unsigned long>(value) & _params.mask)
+				== _params.pattern;
+	}
+
+	return false;
+}
+
+void ScopeCapture::Feed(double position, double velocity, double torque,
+		unsigned long inputs)
+{
+	STATE state = _state.load(std::memory_order_relaxed);
+	if ((state != STATE::Armed) && (state != STATE::Triggered))
+		return;
+
+	if (_disarm.load(std::memory_order_acquire))
+	{
+		_disarm.store(false, std::memory_order_relaxed);
+		_state.store(STATE::Idle, std::memory_order_release);
+		return;
+	}
+
+	const double value[CHANNELS] =
+	{ position, velocity, torque, static_cast<double>(inputs) };
+	const double trigger = value[static_cast<int>(_params.channel)];
+
+	++_cycle;
+
+	// edges need the previous cycle, the level triggers a full pre-trigger window.
+	if ((state == STATE::Armed) && (_cycle > 1)
+			&& (_filled >= _params.preTrigger) && IsTriggered(trigger))
+	{
+		state = STATE::Triggered;
+		_state.store(state, std::memory_order_relaxed);
+		_triggerCycle = _cycle;
+		_remaining = _params.postTrigger;
+		_phase = 0;		// the trigger sample is always kept
+	}
+	_previous = trigger;
+
+	if (_phase == 0)
+	{
+		Sample& sample = _buffer[_write];
+		sample.cycle = _cycle;
+		for (int ch = 0; ch < CHANNELS; ++ch)
+			sample.value[ch] = value[ch];
+
+		if (++_write >= _length)
+			_write = 0;
+		if (_filled < _length)
+			++_filled;
+
+		if ((state == STATE::Triggered) && (--_remaining == 0))
+			_state.store(STATE::Done, std::memory_order_release);
+	}
+
+	if (++_phase >= _params.decimation)
+		_phase = 0;
+}
+
+bool ScopeCapture::Write(const char* fileName)
+{
+	if (_state.load(std::memory_order_acquire) != STATE::Done)
+		return false;
+
+	std::ofstream file(fileName);
+	if (!file.is_open())
+		return false;
+
+	file << "# time[s]\tposition\tvelocity\ttorque\tinputs\n";
+
+	// done -> the buffer is full and the oldest sample is the next slot
+	for (int i = 0; i < _length; ++i)
+	{
+		const Sample& sample = _buffer[(_write + i) % _length];
+		double time = (static_cast<int64_t>(sample.cycle) - _triggerCycle) * _ts;
+
+		file << time << "\t" << sample.value[0] << "\t" << sample.value[1]
+				<< "\t" << sample.value[2] << "\t"
+				<< static_cast<unsigned long>(sample.value[3]) << "\n";
+	}
+
+	file.close();
+	_state.store(STATE::Idle, std::memory_order_release);
+
+	return !file.fail();
+}
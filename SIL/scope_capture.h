@@ -0,0 +1,143 @@
+/*
+ * scope_capture.h
+ *
+ * Created on: Oct 19, 2026
+ * Author: RockyLiu
+ *
+ * Triggered capture of one axis, like the recorder of a scope.
+ *
+ * Once armed, every sync cycle is fed in and every 'decimation'-th one is
+ * kept in a circular buffer of preTrigger + postTrigger samples, so the
+ * history before the trigger is always at hand. The trigger is evaluated on
+ * every cycle, whatever the decimation, and is only accepted once the
+ * pre-trigger window is full. After postTrigger samples (the trigger sample
+ * included) the capture is done and the buffer stays untouched until it is
+ * written out. The RT cost is a few comparisons and one sample copy per cycle.
+ *
+ * Triggers, on any channel:
+ * 	Level	value >= level, as soon as it is true
+ * 	Rising	value crosses level upwards
+ * 	Falling	value crosses level downwards
+ * 	Mask	(value & mask) == pattern, as soon as it is true, for digital inputs
+ *
+ * Hand-off as in FreqResponseAnalyzer: the non-RT side only configures the
+ * capture while it is idle, Arm() publishes it with a release store of the
+ * state, the RT side publishes the finished capture the same way.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+enum class CHANNEL
+{
+	Position, Velocity, Torque, Inputs,
+};
+
+enum class TRIGGER
+{
+	Level, Rising, Falling, Mask,
+};
+
+struct ScopeParams
+{
+	CHANNEL channel = CHANNEL::Position;
+	TRIGGER trigger = TRIGGER::Rising;
+	double level = 0.0;			// channel unit
+	unsigned long mask = 0;		// TRIGGER::Mask
+	unsigned long pattern = 0;	// TRIGGER::Mask
+	int preTrigger = 1000;		// samples
+	int postTrigger = 3000;		// samples, trigger sample included
+	int decimation = 1;			// keep every n-th cycle
+};
+
+class ScopeCapture
+{
+public:
+	static constexpr int MAX_SAMPLES = 8192;
+	static constexpr int CHANNELS = 4;
+
+	enum class STATE
+	{
+		Idle, Armed, Triggered, Done,
+	};
+
+	explicit
+	ScopeCapture(double ts = 0.001);
+	~ScopeCapture() = default;
+
+	ScopeCapture(const ScopeCapture&) = delete;
+	ScopeCapture&
+	operator=(const ScopeCapture&) = delete;
+
+	/*
+	 * Non-RT: configure and arm, false if a capture is armed or running,
+	 * Disarm() it first. A finished capture not written yet is dropped.
+	 */
+	bool
+	Arm(const ScopeParams& params);
+
+	/*
+	 * Non-RT: drop the capture, the RT side goes idle on its next cycle.
+	 */
+	void
+	Disarm(void);
+
+	/*
+	 * RT: feed the measurement of this cycle.
+	 */
+	void
+	Feed(double position, double velocity, double torque, unsigned long inputs);
+
+	STATE
+	GetState(void) const
+	{
+		return _state.load(std::memory_order_acquire);
+	}
+
+	/*
+	 * RT: true while Feed() has something to do, lets the caller skip
+	 * reading the measurement.
+	 */
+	bool
+	IsRecording(void) const
+	{
+		STATE state = _state.load(std::memory_order_relaxed);
+		return (state == STATE::Armed) || (state == STATE::Triggered);
+	}
+
+	/*
+	 * Non-RT: write the finished capture to a text file, one line per
+	 * sample: time from the trigger [s], position, velocity, torque, inputs.
+	 * The capture goes back to idle.
+	 */
+	bool
+	Write(const char* fileName);
+
+private:
+	struct Sample
+	{
+		uint32_t cycle;
+		double value[CHANNELS];
+	};
+
+	bool
+	IsTriggered(double value) const;
+
+	double _ts;
+	std::atomic<STATE> _state;
+	std::atomic<bool> _disarm;
+	ScopeParams _params;
+
+	int _length;			// preTrigger + postTrigger
+	int _write;				// next slot, the oldest sample once done
+	int _filled;
+	int _remaining;			// samples to go after the trigger
+	int _phase;				// decimation counter
+	uint32_t _cycle;
+	uint32_t _triggerCycle;
+	double _previous;
+
+	Sample _buffer[MAX_SAMPLES];
+};
@@ -0,0 +1,384 @@
+/*
+ * setpoint_stream.h
+ *
+ * Created on: Oct 19, 2026
+ * Author: RockyLiu
+ *
+ * Streaming of timestamped position setpoints of N axes from a non-RT
+ * producer (planner, file reader...) into the CSP callback.
+ *
+ * The producer pushes coarse setpoints into an SpscQueue, the RT consumer
+ * pops them as its stream time passes and interpolates to the sync rate,
+ * linearly or with a cubic Hermite spline (Catmull-Rom tangents, which need
+ * one setpoint of look-ahead). The trajectory length is only limited by the
+ * producer, the queue just has to cover its scheduling jitter.
+ *
+ * Stream states, on the RT side:
+ * 	Idle			waiting for 'prefill' setpoints, nothing is output, Rearm()
+ * 					drops what a cancelled stream left queued
+ * 	Streaming		interpolating, the stream time starts at the first setpoint
+ * 	Decelerating	underrun: the queue ran dry before the last setpoint, each
+ * 					axis brakes from its current speed with 'deceleration'
+ * 	Stopped			at rest after the last setpoint or an underrun. Setpoints
+ * 					pushed from now on are dropped until Rearm(), the axes
+ * 					are not where the trajectory expects them any more.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cmath>
+#include "spsc_queue.h"
+
+enum class INTERPOLATION
+{
+	Linear, Cubic,
+};
+
+struct StreamParams
+{
+	INTERPOLATION interpolation = INTERPOLATION::Cubic;
+	int prefill = 3;				// setpoints queued before streaming starts
+	double deceleration = 1.0e6;	// counts/s2 on an underrun
+};
+
+template<int N, int CAPACITY = 1024>
+class SetpointStream
+{
+	static_assert(N >= 1, "SetpointStream needs at least 1 axis!");
+
+public:
+	struct Setpoint
+	{
+		double time;			// s, increasing
+		double position[N];		// counts
+		bool last;				// end of the trajectory, not an underrun
+	};
+
+	enum class STATE
+	{
+		Idle, Streaming, Decelerating, Stopped,
+	};
+
+	explicit
+	SetpointStream(double ts = 0.00025) :
+			_ts(ts), _state(STATE::Idle), _rearm(false), _underruns(0), _minDepth(
+					CAPACITY), _time(0.0), _hasNext(false)
+	{
+		for (int i = 0; i < N; ++i)
+		{
+			_position[i] = 0.0;
+			_velocity[i] = 0.0;
+			_m1[i] = 0.0;
+			_m2[i] = 0.0;
+		}
+	}
+	~SetpointStream() = default;
+
+	SetpointStream(const SetpointStream&) = delete;
+	SetpointStream&
+	operator=(const SetpointStream&) = delete;
+
+	/*
+	 * Non-RT: only while idle, before the first setpoint is pushed.
+	 */
+	void
+	Configure(const StreamParams& params)
+	{
+		_params = params;
+		if (_params.prefill < 2)
+			_params.prefill = 2;
+		if (_params.prefill > CAPACITY)
+			_params.prefill = CAPACITY;
+	}
+
+	/*
+	 * Producer: false when the queue is full or the stream is stopped.
+	 */
+	bool
+	Push(const Setpoint& setpoint)
+	{
+		STATE state = _state.load(std::memory_order_acquire);
+		if ((state == STATE::Decelerating) || (state == STATE::Stopped))
+			return false;
+
+		return _queue.Push(setpoint);
+	}
+
+	/*
+	 * Producer, before a new stream: the RT side drops what is still queued
+	 * (left by a stopped or cancelled stream) and goes idle on its next
+	 * cycle. Push only once IsRearmed().
+	 */
+	void
+	Rearm(void)
+	{
+		_rearm.store(true, std::memory_order_release);
+	}
+
+	/*
+	 * Producer: the last Rearm() is done, the stream is idle and empty.
+	 */
+	bool
+	IsRearmed(void) const
+	{
+		return (_state.load(std::memory_order_acquire) == STATE::Idle)
+				&& !_rearm.load(std::memory_order_acquire);
+	}
+
+	/*
+	 * RT: position of all axes for this cycle, false when there is nothing
+	 * to output (idle or stopped), the caller then holds its last command.
+	 */
+	bool
+	Sample(double* position)
+	{
+		STATE state = _state.load(std::memory_order_relaxed);
+
+		switch (state)
+		{
+		case STATE::Stopped:
+			Flush();
+			if (_rearm.load(std::memory_order_acquire))
+			{
+				_rearm.store(false, std::memory_order_release);
+				_state.store(STATE::Idle, std::memory_order_release);
+			}
+			return false;
+
+		case STATE::Idle:
+			// setpoints of a stream cancelled before it started must not
+			// be played by the next one.
+			if (_rearm.load(std::memory_order_acquire))
+			{
+				Flush();
+				_rearm.store(false, std::memory_order_release);
+				return false;
+			}
+			if (!Start())
+				return false;
+			break;
+
+		case STATE::Decelerating:
+			Decelerate(position);
+			return true;
+
+		case STATE::Streaming:
+			break;
+		}
+
+		// move the segment [p1, p2] along with the stream time
+		while (_time > _p2.time)
+		{
+			if (_p2.last)
+			{
+				Output(_p2.position, position);
+				Stop();
+				return true;
+			}
+
+			if (!_hasNext)
+				_hasNext = _queue.Pop(_p3);
+
+			if (!_hasNext)
+			{
+				_underruns.fetch_add(1, std::memory_order_relaxed);
+				_state.store(STATE::Decelerating, std::memory_order_release);
+				Decelerate(position);
+				return true;
+			}
+
+			_p1 = _p2;
+			_p2 = _p3;
+			_hasNext = false;
+			BeginSegment(false);
+		}
+
+		double target[N];
+		Interpolate(target);
+		Output(target, position);
+
+		_time += _ts;
+
+		int depth = _queue.Size();
+		if (depth < _minDepth.load(std::memory_order_relaxed))
+			_minDepth.store(depth, std::memory_order_relaxed);
+
+		return true;
+	}
+
+	STATE
+	GetState(void) const
+	{
+		return _state.load(std::memory_order_acquire);
+	}
+
+	int
+	GetDepth(void) const
+	{
+		return _queue.Size();
+	}
+
+	/*
+	 * Lowest queue depth seen while streaming.
+	 */
+	int
+	GetMinDepth(void) const
+	{
+		return _minDepth.load(std::memory_order_relaxed);
+	}
+
+	unsigned int
+	GetUnderruns(void) const
+	{
+		return _underruns.load(std::memory_order_relaxed);
+	}
+
+private:
+	bool
+	Start(void)
+	{
+		if (_queue.Size() < _params.prefill)
+			return false;
+
+		_queue.Pop(_p1);
+		_queue.Pop(_p2);
+		_hasNext = false;
+		BeginSegment(true);
+		_time = _p1.time;
+		_minDepth.store(CAPACITY, std::memory_order_relaxed);
+
+		for (int i = 0; i < N; ++i)
+		{
+			_position[i] = _p1.position[i];
+			_velocity[i] = 0.0;
+		}
+
+		_state.store(STATE::Streaming, std::memory_order_release);
+
+		return true;
+	}
+
+	void
+	Stop(void)
+	{
+		for (int i = 0; i < N; ++i)
+			_velocity[i] = 0.0;
+
+		_state.store(STATE::Stopped, std::memory_order_release);
+	}
+
+	void
+	Flush(void)
+	{
+		while (_queue.Front())
+			_queue.Pop();
+		_hasNext = false;
+	}
+
+	/*
+	 * Tangents of the new segment [p1, p2], fixed until it ends: m1 is m2 of
+	 * the previous segment (the secant on the first one), m2 the Catmull-Rom
+	 * tangent if p3 is already queued, the secant otherwise. A look-ahead
+	 * arriving later in the segment is only used by the next one.
+	 */
+	void
+	BeginSegment(bool first)
+	{
+		if (_params.interpolation != INTERPOLATION::Cubic)
+			return;
+
+		if (!_hasNext)
+			_hasNext = _queue.Pop(_p3);
+
+		const double h = _p2.time - _p1.time;
+		const double h1 = _hasNext ? _p3.time - _p1.time : h;
+
+		for (int i = 0; i < N; ++i)
+		{
+			const double secant = (h > 0.0) ? (_p2.position[i] - _p1.position[i]) / h : 0.0;
+
+			_m1[i] = first ? secant : _m2[i];
+			_m2[i] = (_hasNext && (h1 > 0.0)) ?
+					(_p3.position[i] - _p1.position[i]) / h1 : secant;
+		}
+	}
+
+	void
+	Interpolate(double* target) const
+	{
+		const double h = _p2.time - _p1.time;
+		const double s = (h > 0.0) ? (_time - _p1.time) / h : 1.0;
+
+		if (_params.interpolation == INTERPOLATION::Linear)
+		{
+			for (int i = 0; i < N; ++i)
+				target[i] = _p1.position[i] + s * (_p2.position[i] - _p1.position[i]);
+			return;
+		}
+
+		const double s2 = s * s;
+		const double s3 = s2 * s;
+		const double h00 = 2.0 * s3 - 3.0 * s2 + 1.0;
+		const double h10 = s3 - 2.0 * s2 + s;
+		const double h01 = 3.0 * s2 - 2.0 * s3;
+		const double h11 = s3 - s2;
+
+		// tangents fixed by BeginSegment()
+		for (int i = 0; i < N; ++i)
+			target[i] = h00 * _p1.position[i] + h10 * h * _m1[i]
+					+ h01 * _p2.position[i] + h11 * h * _m2[i];
+	}
+
+	/*
+	 * Keep the speed of each axis, it is where an underrun brakes from.
+	 */
+	void
+	Output(const double* target, double* position)
+	{
+		for (int i = 0; i < N; ++i)
+		{
+			_velocity[i] = (target[i] - _position[i]) / _ts;
+			_position[i] = target[i];
+			position[i] = target[i];
+		}
+	}
+
+	void
+	Decelerate(double* position)
+	{
+		const double step = _params.deceleration * _ts;
+		bool moving = false;
+
+		for (int i = 0; i < N; ++i)
+		{
+			double v = _velocity[i];
+			double dv = (std::fabs(v) > step) ? std::copysign(step, v) : v;
+
+			_velocity[i] = v - dv;
+			_position[i] += _velocity[i] * _ts;
+			position[i] = _position[i];
+			moving = moving || (_velocity[i] != 0.0);
+		}
+
+		if (!moving)
+			Stop();
+	}
+
+	double _ts;
+	StreamParams _params;
+	SpscQueue<Setpoint, CAPACITY> _queue;
+
+	std::atomic<STATE> _state;
+	std::atomic<bool> _rearm;
+	std::atomic<unsigned int> _underruns;
+	std::atomic<int> _minDepth;
+
+	// RT only
+	double _time;				// stream time, s
+	Setpoint _p1, _p2, _p3;		// segment [p1, p2], p3 valid when _hasNext
+	bool _hasNext;
+	double _m1[N], _m2[N];		// counts/s, cubic tangents at p1 / p2
+	double _position[N];		// last output
+	double _velocity[N];		// counts/s
+};
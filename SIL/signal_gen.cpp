@@ -0,0 +1,223 @@
+/*
+ * signal_gen.cpp
+ *
+ * Created on: Oct 19, 2026
+ * Author: RockyLiu
+ */
+
+#include "signal_gen.h"
+#include <cmath>
+
+namespace
+{
+	constexpr int TABLE_BITS = 12;
+	constexpr int TABLE_SIZE = 1 << TABLE_BITS;
+	constexpr int FRAC_BITS = 32 - TABLE_BITS;
+	constexpr double TWO_POW_32 = 4294967296.0;
+	constexpr double TWO_PI = 6.2831853071795862;
+
+	/**
+	 * One turn of sine plus a guard point, so the interpolation never wraps.
+	 */
+	struct SineTable
+	{
+		float value[TABLE_SIZE + 1];
+
+		SineTable()
+		{
+			for (int i = 0; i <= TABLE_SIZE; ++i)
+				value[i] = static_cast<float>(std::sin(TWO_PI * i / TABLE_SIZE));
+		}
+	};
+
+	const SineTable sineTable;
+
+	uint32_t
+	ToPhase(double rad)
+	{
+		double turns = rad / TWO_PI;
+		turns -= std::floor(turns);
+		return static_cast<uint32_t>(turns * TWO_POW_32);
+	}
+}
+
+SignalGenerator::SignalGenerator(double ts) :
+		_ts(ts), _fs(1.0 / ts), _block(Program
+		{ }), _program(), _generation(0), _phase(0), _increment(0.0), _chirpCount(
+				0), _lfsr(0xACE1u), _prbsCount(0), _prbsLevel(1.0), _tonePhase
+		{ 0 }
+{
+}
+
+double SignalGenerator::Sin(uint32_t phase)
+{
+	uint32_t index = phase >> FRAC_BITS;
+	double frac = static_cast<double>(phase & ((1u << FRAC_BITS) - 1))
+			* (1.0 / (1u << FRAC_BITS));
+	double y0 = sineTable.value[index];
+
+	return y0 + (sineTable.value[index + 1] - y0) * frac;
+}
+
+bool SignalGenerator::Configure(const SignalParams& params)
+{
+	// above fs/2 the phase increment aliases, at 0 a log chirp ratio is inf
+	const double nyquist = 0.5 * _fs;
+	auto inBand = [nyquist](double frequency)
+	{
+		return (frequency > 0.0) && (frequency < nyquist);
+	};
+
+	switch (params.waveform)
+	{
+	case WAVEFORM::MultiSine:
+		for (int i = 0; i < params.toneCount && i < SignalParams::MAX_TONES; ++i)
+			if (!inBand(params.toneFrequency[i]))
+				return false;
+		break;
+	case WAVEFORM::LinChirp:
+	case WAVEFORM::LogChirp:
+		if (!inBand(params.frequency) || !inBand(params.endFrequency))
+			return false;
+		break;
+	case WAVEFORM::Prbs:
+		break;
+	default:
+		if (!inBand(params.frequency))
+			return false;
+		break;
+	}
+
+	Program program
+	{ };
+
+	program.waveform = params.waveform;
+	program.amplitude = params.amplitude;
+	program.offset = params.offset;
+	program.increment = params.frequency * _ts * TWO_POW_32;
+	program.chirpLength = static_cast<unsigned int>(params.sweepTime * _fs);
+	if (program.chirpLength < 1)
+		program.chirpLength = 1;
+
+	if (params.waveform == WAVEFORM::LogChirp)
+		program.chirpStep = std::pow(params.endFrequency / params.frequency,
+				1.0 / program.chirpLength);
+	else
+		program.chirpStep = (params.endFrequency - params.frequency) * _ts
+				* TWO_POW_32 / program.chirpLength;
+
+	double duty = params.duty < 0.0 ? 0.0 : (params.duty > 1.0 ? 1.0 : params.duty);
+	program.dutyPhase = static_cast<uint32_t>(duty * (TWO_POW_32 - 1.0));
+	program.prbsDivider = params.prbsDivider < 1 ? 1 : params.prbsDivider;
+
+	program.toneCount =
+			params.toneCount > SignalParams::MAX_TONES ?
+					SignalParams::MAX_TONES : params.toneCount;
+	for (int i = 0; i < program.toneCount; ++i)
+	{
+		program.toneIncrement[i] = static_cast<uint32_t>(params.toneFrequency[i]
+				* _ts * TWO_POW_32);
+		program.toneStartPhase[i] = ToPhase(params.tonePhase[i]);
+		program.toneAmplitude[i] = params.toneAmplitude[i];
+	}
+
+	_block.Publish(program);
+
+	return true;
+}
+
+void SignalGenerator::Restart(void)
+{
+	_phase = 0;
+	_increment = _program.increment;
+	_chirpCount = 0;
+	_prbsCount = 0;
+
+	for (int i = 0; i < _program.toneCount; ++i)
+		_tonePhase[i] = _program.toneStartPhase[i];
+}
+
+double SignalGenerator::Sample(void)
+{
+	WAVEFORM prevWaveform = _program.waveform;
+
+	if (_block.TryRead(_program, _generation))
+	{
+		// keep the phase continuous if only amplitude / frequency / offset of a
+		// periodic waveform changed, sweeps and tone sets start over.
+		if ((_program.waveform != prevWaveform)
+				|| (_program.waveform == WAVEFORM::MultiSine)
+				|| (_program.waveform == WAVEFORM::LinChirp)
+				|| (_program.waveform == WAVEFORM::LogChirp))
+			Restart();
+		else
+			_increment = _program.increment;
+	}
+
+	double value = 0.0;
+
+	switch (_program.waveform)
+	{
+	case WAVEFORM::Sine:
+	{
+		value = Sin(_phase);
+		break;
+	}
+	case WAVEFORM::MultiSine:
+	{
+		for (int i = 0; i < _program.toneCount; ++i)
+		{
+			value += _program.toneAmplitude[i] * Sin(_tonePhase[i]);
+			_tonePhase[i] += _program.toneIncrement[i];
+		}
+		return _program.offset + value;
+	}
+	case WAVEFORM::LinChirp:
+	case WAVEFORM::LogChirp:
+	{
+		value = Sin(_phase);
+
+		if (++_chirpCount >= _program.chirpLength)
+		{
+			_chirpCount = 0;
+			_increment = _program.increment;
+		}
+		else if (_program.waveform == WAVEFORM::LinChirp)
+			_increment += _program.chirpStep;
+		else
+			_increment *= _program.chirpStep;
+		break;
+	}
+	case WAVEFORM::Square:
+	{
+		value = (_phase < _program.dutyPhase) ? 1.0 : -1.0;
+		break;
+	}
+	case WAVEFORM::Triangle:
+	{
+		// 0 -> 1 -> 0 -> -1 -> 0 over one turn, d = distance to the peak in [-0.5, 0.5)
+		int32_t shifted = static_cast<int32_t>(_phase - 0x40000000u);
+		double d = static_cast<double>(shifted) * (1.0 / TWO_POW_32);
+		value = 1.0 - 4.0 * (d < 0.0 ? -d : d);
+		break;
+	}
+	case WAVEFORM::Prbs:
+	{
+		// 16 bits maximal length LFSR, x^16 + x^14 + x^13 + x^11 + 1
+		if (_prbsCount == 0)
+		{
+			uint16_t bit = ((_lfsr >> 0) ^ (_lfsr >> 2) ^ (_lfsr >> 3) ^ (_lfsr >> 5)) & 1u;
+			_lfsr = (_lfsr >> 1) | (bit << 15);
+			_prbsLevel = (_lfsr & 1u) ? 1.0 : -1.0;
+		}
+		if (++_prbsCount >= _program.prbsDivider)
+			_prbsCount = 0;
+
+		return _program.offset + _program.amplitude * _prbsLevel;
+	}
+	}
+
+	_phase += static_cast<uint32_t>(_increment);
+
+	return _program.offset + _program.amplitude * value;
+}
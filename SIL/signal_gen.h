@@ -0,0 +1,146 @@
+/*
+ * signal_gen.h
+ *
+ * Created on: Oct 19, 2026
+ * Author: RockyLiu
+ *
+ * Real-time signal generator for system identification and burn-in tests.
+ *
+ * Every waveform runs from a 32 bits phase accumulator (one full turn is
+ * 2^32) and a 4096 points sine table with linear interpolation, so a sample
+ * costs a constant number of integer & multiply-add operations and no libm
+ * call. Everything that needs libm (log chirp ratio, frequency to phase
+ * increment) is computed by Configure() on the non-RT side, the RT side
+ * picks the new program up on its next Sample() through a ParamBlock.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include "param_block.h"
+
+enum class WAVEFORM
+{
+	Sine, MultiSine, LinChirp, LogChirp, Square, Triangle, Prbs,
+};
+
+/**
+ * User settings, in engineering units.
+ */
+struct SignalParams
+{
+	static constexpr int MAX_TONES = 8;
+
+	WAVEFORM waveform = WAVEFORM::Sine;
+	double amplitude = 0.0;
+	double frequency = 1.0;			// Hz, start frequency of the chirps
+	double offset = 0.0;
+
+	double endFrequency = 10.0;		// Hz, chirps only
+	double sweepTime = 10.0;		// s, chirps only, the sweep restarts at the end
+	double duty = 0.5;				// square only, [0, 1]
+	unsigned int prbsDivider = 1;	// PRBS only, samples per bit
+
+	int toneCount = 0;				// multi sine only, frequency & amplitude above are not used
+	double toneFrequency[MAX_TONES] =
+	{ 0.0 };
+	double toneAmplitude[MAX_TONES] =
+	{ 0.0 };
+	double tonePhase[MAX_TONES] =
+	{ 0.0 };						// rad, e.g. Schroeder phases to keep the crest factor low
+};
+
+class SignalGenerator
+{
+public:
+	explicit
+	SignalGenerator(double ts = 0.00025);
+	~SignalGenerator() = default;
+
+	SignalGenerator(const SignalGenerator&) = delete;
+	SignalGenerator&
+	operator=(const SignalGenerator&) = delete;
+
+	/*
+	 * Non-RT: compute and publish a new program, false if a frequency the
+	 * waveform uses is outside (0, fs/2), nothing is published then.
+	 */
+	bool
+	Configure(const SignalParams& params);
+
+	/*
+	 * RT: next sample, constant time.
+	 */
+	double
+	Sample(void);
+
+	/*
+	 * RT: phase of the fundamental / chirp after the last sample, 2^32 = 1 turn.
+	 */
+	uint32_t
+	GetPhase(void) const
+	{
+		return _phase;
+	}
+
+	/*
+	 * RT: instantaneous frequency of the last sample in Hz.
+	 */
+	double
+	GetFrequency(void) const
+	{
+		return _increment * _fs / 4294967296.0;
+	}
+
+	/*
+	 * Interpolated sine of a 32 bits phase, shared by other RT modules.
+	 */
+	static double
+	Sin(uint32_t phase);
+
+	static double
+	Cos(uint32_t phase)
+	{
+		return Sin(phase + 0x40000000u);
+	}
+
+private:
+	/**
+	 * Everything the RT side needs, precomputed by Configure().
+	 */
+	struct Program
+	{
+		WAVEFORM waveform;
+		double amplitude;
+		double offset;
+
+		double increment;		// phase increment per sample, 2^32 = 1 turn
+		double chirpStep;		// linear: added to increment, log: multiplies increment
+		unsigned int chirpLength;	// samples per sweep
+		uint32_t dutyPhase;
+		unsigned int prbsDivider;
+
+		int toneCount;
+		uint32_t toneIncrement[SignalParams::MAX_TONES];
+		uint32_t toneStartPhase[SignalParams::MAX_TONES];
+		double toneAmplitude[SignalParams::MAX_TONES];
+	};
+
+	void
+	Restart(void);
+
+	double _ts;
+	double _fs;
+
+	ParamBlock<Program> _block;
+	Program _program;
+	unsigned int _generation;
+
+	uint32_t _phase;
+	double _increment;
+	unsigned int _chirpCount;
+	uint16_t _lfsr;
+	unsigned int _prbsCount;
+	double _prbsLevel;
+	uint32_t _tonePhase[SignalParams::MAX_TONES];
+};
@@ -0,0 +1,134 @@
+/*
+ * spsc_queue.h
+ *
+ * Created on: Oct 19, 2026
+ * Author: RockyLiu
+ *
+ * Bounded single producer / single consumer queue, lock free and wait free.
+ *
+ * Exactly one thread pushes and one thread pops, either of them can be the
+ * RT callback. The elements live in a fixed power-of-two ring, nothing is
+ * allocated after construction. Head and tail sit on their own cache lines,
+ * each side caches the index of the other one and only reloads it when the
+ * ring looks full / empty, so the common case touches no shared line.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+template<typename T, int CAPACITY>
+class SpscQueue
+{
+	static_assert((CAPACITY >= 2) && ((CAPACITY & (CAPACITY - 1)) == 0),
+			"SpscQueue capacity must be a power of two!");
+
+public:
+	SpscQueue() :
+			_head(0), _tailCache(0), _tail(0), _headCache(0)
+	{
+	}
+	~SpscQueue() = default;
+
+	SpscQueue(const SpscQueue&) = delete;
+	SpscQueue&
+	operator=(const SpscQueue&) = delete;
+
+	/*
+	 * Producer: false when full, the element is not queued.
+	 */
+	bool
+	Push(const T& item)
+	{
+		const uint32_t tail = _tail.load(std::memory_order_relaxed);
+
+		if (tail - _headCache == CAPACITY)
+		{
+			_headCache = _head.load(std::memory_order_acquire);
+			if (tail - _headCache == CAPACITY)
+				return false;
+		}
+
+		_ring[tail & MASK] = item;
+		_tail.store(tail + 1, std::memory_order_release);
+
+		return true;
+	}
+
+	/*
+	 * Consumer: oldest element, nullptr when empty. It stays valid until Pop().
+	 */
+	const T*
+	Front(void)
+	{
+		const uint32_t head = _head.load(std::memory_order_relaxed);
+
+		if (head == _tailCache)
+		{
+			_tailCache = _tail.load(std::memory_order_acquire);
+			if (head == _tailCache)
+				return nullptr;
+		}
+
+		return &_ring[head & MASK];
+	}
+
+	/*
+	 * Consumer: drop the oldest element, only after Front() returned one.
+	 */
+	void
+	Pop(void)
+	{
+		_head.store(_head.load(std::memory_order_relaxed) + 1,
+				std::memory_order_release);
+	}
+
+	/*
+	 * Consumer: copy out and drop the oldest element, false when empty.
+	 */
+	bool
+	Pop(T& item)
+	{
+		const T* front = Front();
+		if (!front)
+			return false;
+
+		item = *front;
+		Pop();
+
+		return true;
+	}
+
+	/*
+	 * Either side: number of queued elements, exact for the calling side
+	 * only, a snapshot for the other one.
+	 */
+	int
+	Size(void) const
+	{
+		const uint32_t head = _head.load(std::memory_order_acquire);
+		const uint32_t tail = _tail.load(std::memory_order_acquire);
+
+		return static_cast<int>(tail - head);
+	}
+
+	static constexpr int
+	Capacity(void)
+	{
+		return CAPACITY;
+	}
+
+private:
+	static constexpr uint32_t MASK = CAPACITY - 1;
+
+	// consumer line
+	alignas(64) std::atomic<uint32_t> _head;
+	uint32_t _tailCache;
+
+	// producer line
+	alignas(64) std::atomic<uint32_t> _tail;
+	uint32_t _headCache;
+
+	alignas(64) T _ring[CAPACITY];
+};
@@ -0,0 +1,92 @@
+/*
+ * state_observer.cpp
+ *
+ * Created on: Oct 19, 2026
+ * Author: RockyLiu
+ */
+
+#include "state_observer.h"
+#include <cmath>
+
+namespace
+{
+	constexpr int MAX_ITERATIONS = 100000;
+	constexpr double TOLERANCE = 1e-12;
+}
+
+StateObserver::StateObserver(const ObserverParams& params)
+{
+	Configure(params);
+}
+
+void StateObserver::Configure(const ObserverParams& params)
+{
+	const double ts = params.ts;
+	const double f[3][3] =
+	{
+	{ 1.0, ts, 0.5 * ts * ts },
+	{ 0.0, 1.0, ts },
+	{ 0.0, 0.0, 1.0 } };
+
+	// discrete white jerk process noise
+	const double q = params.jerkNoise * params.jerkNoise;
+	const double ts2 = ts * ts, ts3 = ts2 * ts, ts4 = ts3 * ts, ts5 = ts4 * ts;
+	const double qd[3][3] =
+	{
+	{ q * ts5 / 20.0, q * ts4 / 8.0, q * ts3 / 6.0 },
+	{ q * ts4 / 8.0, q * ts3 / 3.0, q * ts2 / 2.0 },
+	{ q * ts3 / 6.0, q * ts2 / 2.0, q * ts } };
+
+	const double r = params.positionNoise * params.positionNoise;
+
+	double p[3][3] =
+	{
+	{ r, 0.0, 0.0 },
+	{ 0.0, r / ts2, 0.0 },
+	{ 0.0, 0.0, r / ts4 } };
+	double gain[3] =
+	{ 0.0, 0.0, 0.0 };
+
+	for (int n = 0; n < MAX_ITERATIONS; ++n)
+	{
+		// prior covariance M = F P F' + Q
+		double fp[3][3], m[3][3];
+
+		for (int i = 0; i < 3; ++i)
+			for (int j = 0; j < 3; ++j)
+				fp[i][j] = f[i][0] * p[0][j] + f[i][1] * p[1][j] + f[i][2] * p[2][j];
+
+		for (int i = 0; i < 3; ++i)
+			for (int j = 0; j < 3; ++j)
+				m[i][j] = fp[i][0] * f[j][0] + fp[i][1] * f[j][1] + fp[i][2] * f[j][2]
+						+ qd[i][j];
+
+		// position measurement only, the innovation covariance is a scalar
+		double s = m[0][0] + r;
+		double change = 0.0;
+
+		for (int i = 0; i < 3; ++i)
+		{
+			double k = m[i][0] / s;
+			change = std::fmax(change, std::fabs(k - gain[i]) / std::fmax(std::fabs(k), 1e-300));
+			gain[i] = k;
+		}
+
+		for (int i = 0; i < 3; ++i)
+			for (int j = 0; j < 3; ++j)
+				p[i][j] = m[i][j] - gain[i] * m[0][j];
+
+		if (change < TOLERANCE)
+			break;
+	}
+
+	_ts = ts;
+	_halfTs = 0.5 * ts;
+	_torqueGain = params.torqueGain;
+	_gain[0] = gain[0];
+	_gain[1] = gain[1];
+	_gain[2] = gain[2];
+
+	_initialized = false;
+	_position = _velocity = _acceleration = 0.0;
+}
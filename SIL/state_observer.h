@@ -0,0 +1,123 @@
+/*
+ * state_observer.h
+ *
+ * Created on: Oct 19, 2026
+ * Author: RockyLiu
+ *
+ * Steady-state Kalman observer of position / velocity / acceleration.
+ *
+ * Model: constant acceleration driven by white jerk, the measured torque
+ * enters through 'torqueGain' (acceleration per torque unit, 0 -> unknown,
+ * pure kinematic model). The third state is then the acceleration not
+ * explained by the torque, i.e. the disturbance (friction, load, gravity).
+ *
+ * The gains are the converged solution of the Riccati equation, computed once
+ * on the non-RT side by Configure(), so Update() is a fixed predict / correct
+ * step of about 20 flops, no branch on the RT path.
+ */
+
+#pragma once
+
+struct ObserverParams
+{
+	double ts = 0.00025;			// s, sync period
+	double positionNoise = 0.29;	// counts rms, 1/sqrt(12) -> encoder quantization
+	double jerkNoise = 5.0e7;		// counts/s^3/sqrt(Hz), higher -> faster, noisier
+	double torqueGain = 0.0;		// counts/s^2 per torque unit, 0 -> no torque input
+};
+
+class StateObserver
+{
+public:
+	explicit
+	StateObserver(const ObserverParams& params = ObserverParams());
+	~StateObserver() = default;
+
+	/*
+	 * Non-RT: compute the steady-state gains, restart from the next measurement.
+	 */
+	void
+	Configure(const ObserverParams& params);
+
+	/*
+	 * RT: once per sync cycle with the measured position and torque.
+	 */
+	void
+	Update(double position, double torque)
+	{
+		if (!_initialized)
+		{
+			_position = position;
+			_velocity = _acceleration = 0.0;
+			_initialized = true;
+			return;
+		}
+
+		// predict
+		double acceleration = _acceleration + _torqueGain * torque;
+		double predicted = _position + (_velocity + _halfTs * acceleration) * _ts;
+		double velocity = _velocity + acceleration * _ts;
+
+		// correct
+		double innovation = position - predicted;
+		_position = predicted + _gain[0] * innovation;
+		_velocity = velocity + _gain[1] * innovation;
+		_acceleration += _gain[2] * innovation;
+	}
+
+	double
+	GetPosition(void) const
+	{
+		return _position;
+	}
+
+	double
+	GetVelocity(void) const
+	{
+		return _velocity;
+	}
+
+	/*
+	 * Total acceleration, torque contribution included.
+	 */
+	double
+	GetAcceleration(double torque) const
+	{
+		return _acceleration + _torqueGain * torque;
+	}
+
+	/*
+	 * Disturbance in torque unit (positive assists the motion), 0 without torque gain.
+	 */
+	double
+	GetDisturbance(void) const
+	{
+		return (_torqueGain != 0.0) ? _acceleration / _torqueGain : 0.0;
+	}
+
+	double
+	GetTorqueGain(void) const
+	{
+		return _torqueGain;
+	}
+
+	/*
+	 * Steady-state gains, [0] position, [1] velocity, [2] acceleration.
+	 */
+	double
+	GetGain(int i) const
+	{
+		return _gain[i];
+	}
+
+private:
+	double _ts;
+	double _halfTs;
+	double _torqueGain;
+	double _gain[3];
+
+	bool _initialized;
+	double _position;
+	double _velocity;
+	double _acceleration;
+};
@@ -0,0 +1,76 @@
+/*
+ * torque_map.cpp
+ *
+ * Created on: Oct 19, 2026
+ * Author: RockyLiu
+ */
+
+#include "torque_map.h"
+
+TorqueMap::TorqueMap() :
+		_period(1.0), _scale(4294967296.0)
+{
+	for (int i = 0; i <= SIZE; ++i)
+		_table[i] = 0.0f;
+}
+
+void TorqueMap::SetPeriod(double period)
+{
+	_period = period;
+	_scale = 4294967296.0 / period;
+}
+
+void TorqueMap::BuildDetents(double period, double kp, double limit)
+{
+	Build(period, [=](double x)
+	{
+		// distance to the nearest detent, counts
+		double error = ((x < 0.5) ? -x : (1.0 - x)) * period;
+		double torque = kp * error;
+
+		return (torque > limit) ? limit : (torque < -limit) ? -limit : torque;
+	});
+}
+
+void TorqueMap::BuildClick(double period, double peak, double rise)
+{
+	if (rise <= 0.0 || rise >= 1.0)
+		rise = 0.5;
+
+	Build(period, [=](double x)
+	{
+		return (x < rise) ? peak * x / rise : peak * (1.0 - x) / (1.0 - rise);
+	});
+}
+
+bool TorqueMap::BuildPoints(double period, const double* position,
+		const double* torque, int count)
+{
+	if (count < 1 || count > MAX_POINTS)
+		return false;
+
+	for (int i = 1; i < count; ++i)
+	{
+		if (position[i] <= position[i - 1])
+			return false;
+	}
+
+	Build(period, [=](double x)
+	{
+		double p = x * period;
+
+		// segment [i - 1, i], the first one wraps from the last point
+		int i = 0;
+		while (i < count && position[i] <= p)
+			++i;
+
+		double p0 = (i == 0) ? position[count - 1] - period : position[i - 1];
+		double t0 = (i == 0) ? torque[count - 1] : torque[i - 1];
+		double p1 = (i == count) ? position[0] + period : position[i];
+		double t1 = (i == count) ? torque[0] : torque[i];
+
+		return (p1 > p0) ? t0 + (t1 - t0) * (p - p0) / (p1 - p0) : t0;
+	});
+
+	return true;
+}
@@ -0,0 +1,104 @@
+/*
+ * torque_map.h
+ *
+ * Created on: Oct 19, 2026
+ * Author: RockyLiu
+ *
+ * Periodic torque versus position profile (detents, asymmetric clicks,
+ * cogging compensation...) sampled into a power-of-two table.
+ *
+ * The position is scaled once to a 32-bit phase of the period, the upper
+ * BITS select the table entry and the lower ones interpolate linearly, so
+ * Evaluate() is a multiply, a shift, a mask and one multiply-add whatever
+ * the profile, and wraps around the period for free (negative positions too).
+ *
+ * Maps are built on the non-RT side, before being published to an effect.
+ * A map referenced by a running effect must not be rebuilt, build another
+ * one and publish it instead.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+class TorqueMap
+{
+public:
+	static constexpr int BITS = 10;
+	static constexpr int SIZE = 1 << BITS;
+	static constexpr int MAX_POINTS = 32;
+
+	TorqueMap();
+	~TorqueMap() = default;
+
+	TorqueMap(const TorqueMap&) = delete;
+	TorqueMap&
+	operator=(const TorqueMap&) = delete;
+
+	/*
+	 * Non-RT: sample 'profile(x)', x in [0, 1) of the period, period in counts.
+	 */
+	template<class Profile>
+	void
+	Build(double period, Profile profile)
+	{
+		SetPeriod(period);
+
+		for (int i = 0; i < SIZE; ++i)
+			_table[i] = static_cast<float>(profile(static_cast<double>(i) / SIZE));
+		_table[SIZE] = _table[0];
+	}
+
+	/*
+	 * Non-RT: detents at every multiple of the period, spring of 'kp' per count
+	 * towards the nearest one, clipped at +/- limit (RatchetEffect equivalent).
+	 */
+	void
+	BuildDetents(double period, double kp, double limit);
+
+	/*
+	 * Non-RT: asymmetric click, the torque rises to 'peak' over the first
+	 * 'rise' fraction of the period and falls back to 0 over the rest.
+	 */
+	void
+	BuildClick(double period, double peak, double rise);
+
+	/*
+	 * Non-RT: designer profile, 'count' points (position in [0, period),
+	 * ascending; torque), interpolated linearly and wrapped around the period.
+	 */
+	bool
+	BuildPoints(double period, const double* position, const double* torque,
+			int count);
+
+	/*
+	 * RT: torque at 'position', counts.
+	 */
+	double
+	Evaluate(double position) const
+	{
+		uint32_t phase = static_cast<uint32_t>(static_cast<int64_t>(position * _scale));
+		uint32_t index = phase >> SHIFT;
+		float frac = static_cast<float>(phase & MASK) * FRAC_SCALE;
+
+		return _table[index] + (_table[index + 1] - _table[index]) * frac;
+	}
+
+	double
+	GetPeriod(void) const
+	{
+		return _period;
+	}
+
+private:
+	static constexpr int SHIFT = 32 - BITS;
+	static constexpr uint32_t MASK = (1u << SHIFT) - 1;
+	static constexpr float FRAC_SCALE = 1.0f / (1u << SHIFT);
+
+	void
+	SetPeriod(double period);
+
+	double _period;
+	double _scale;			// phase per count
+	float _table[SIZE + 1];	// last entry repeats the first, no wrap test when interpolating
+};
@@ -0,0 +1,356 @@
+/*
+ * virtual_fixture.h
+ *
+ * Created on: Oct 19, 2026
+ * Author: RockyLiu
+ *
+ * Virtual fixtures: keep-out boxes and forbidden half-spaces for one axis
+ * (Dims = 1, boxes are intervals) or for a group of axes, each with its
+ * own stiffness and damping.
+ *
+ * Spatial index: the extent of the fixtures along the first coordinate is
+ * split in BUCKETS equal buckets, each one listing the fixtures overlapping
+ * it, fixtures unbounded along that coordinate are kept in a separate list.
+ * A cycle tests only the fixtures of the bucket of the current position plus
+ * the unbounded ones.
+ *
+ * Swap: two fixture sets, the non-RT side builds the spare one and publishes
+ * it with a pointer store, the RT side acknowledges the set it runs on at
+ * the start of each cycle. Publish() refuses to overwrite a set until the RT
+ * side moved to the latest one, so a set is never modified while in use and
+ * the RT side never copies more than a pointer.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+
+enum class FIXTURE
+{
+	Box,		// keep-out box, pushed out through the nearest face
+	HalfSpace,	// forbidden region normal . x > offset, normal of unit length
+};
+
+template<int Dims>
+class VirtualFixtures
+{
+public:
+	static constexpr int MAX_FIXTURES = 256;
+	static constexpr int BUCKETS = 64;
+
+	struct Fixture
+	{
+		FIXTURE kind;
+		double lower[Dims];		// Box
+		double upper[Dims];
+		double normal[Dims];	// HalfSpace
+		double offset;
+		double stiffness;		// torque per count of penetration
+		double damping;			// torque per count/s, inside the fixture only
+	};
+
+	static Fixture
+	Box(const double* lower, const double* upper, double stiffness, double damping)
+	{
+		Fixture fixture = Fixture();
+		fixture.kind = FIXTURE::Box;
+		for (int d = 0; d < Dims; ++d)
+		{
+			fixture.lower[d] = lower[d];
+			fixture.upper[d] = upper[d];
+		}
+		fixture.stiffness = stiffness;
+		fixture.damping = damping;
+		return fixture;
+	}
+
+	static Fixture
+	HalfSpace(const double* normal, double offset, double stiffness, double damping)
+	{
+		Fixture fixture = Fixture();
+		fixture.kind = FIXTURE::HalfSpace;
+		for (int d = 0; d < Dims; ++d)
+			fixture.normal[d] = normal[d];
+		fixture.offset = offset;
+		fixture.stiffness = stiffness;
+		fixture.damping = damping;
+		return fixture;
+	}
+
+	VirtualFixtures() :
+			_active(&_sets[0]), _acquired(&_sets[0]), _tested(0)
+	{
+		_sets[0].count = _sets[1].count = 0;
+		_sets[0].unboundedCount = _sets[1].unboundedCount = 0;
+		_sets[0].invWidth = _sets[1].invWidth = 0.0;
+		_sets[0].origin = _sets[1].origin = 0.0;
+		for (int b = 0; b <= BUCKETS; ++b)
+			_sets[0].bucketStart[b] = _sets[1].bucketStart[b] = 0;
+	}
+
+	VirtualFixtures(const VirtualFixtures&) = delete;
+	VirtualFixtures&
+	operator=(const VirtualFixtures&) = delete;
+
+	/*
+	 * Non-RT: build and publish a new set, false if there are too many
+	 * fixtures or if the RT side has not picked up the previous set yet
+	 * (try again on the next Modbus cycle).
+	 */
+	bool
+	Publish(const Fixture* fixtures, int count)
+	{
+		if (count < 0 || count > MAX_FIXTURES)
+			return false;
+
+		Set* active = _active.load(std::memory_order_acquire);
+		if (_acquired.load(std::memory_order_acquire) != active)
+			return false;
+
+		Set* spare = (active == &_sets[0]) ? &_sets[1] : &_sets[0];
+		Build(*spare, fixtures, count);
+
+		_active.store(spare, std::memory_order_release);
+
+		return true;
+	}
+
+	/*
+	 * RT: sum of the fixture forces at 'position' moving at 'velocity'.
+	 */
+	void
+	operator()(const double* position, const double* velocity, double* force)
+	{
+		const Set* set = _active.load(std::memory_order_acquire);
+		_acquired.store(const_cast<Set*>(set), std::memory_order_release);
+
+		for (int d = 0; d < Dims; ++d)
+			force[d] = 0.0;
+
+		int tested = set->unboundedCount;
+
+		for (int i = 0; i < set->unboundedCount; ++i)
+			Apply(set->fixture[set->unbounded[i]], position, velocity, force);
+
+		int bucket = Bucket(*set, position[0]);
+		int begin = set->bucketStart[bucket];
+		int end = set->bucketStart[bucket + 1];
+
+		for (int i = begin; i < end; ++i)
+			Apply(set->fixture[set->entry[i]], position, velocity, force);
+
+		_tested = tested + end - begin;
+	}
+
+	/*
+	 * Number of fixtures tested in the last cycle.
+	 */
+	int
+	GetTested(void) const
+	{
+		return _tested;
+	}
+
+private:
+	struct Set
+	{
+		int count;
+		Fixture fixture[MAX_FIXTURES];
+
+		int unboundedCount;
+		uint16_t unbounded[MAX_FIXTURES];
+
+		double origin;		// first coordinate of bucket 0
+		double invWidth;	// buckets per count
+		uint16_t bucketStart[BUCKETS + 1];
+		uint16_t entry[MAX_FIXTURES * BUCKETS];
+	};
+
+	static int
+	Bucket(const Set& set, double x)
+	{
+		double bucket = (x - set.origin) * set.invWidth;
+		return !(bucket > 0.0) ? 0 :	// NaN too, infinite bound with a single bucket
+				(bucket >= BUCKETS) ? (BUCKETS - 1) : static_cast<int>(bucket);
+	}
+
+	/*
+	 * Extent of a fixture along the first coordinate, false if unbounded.
+	 */
+	static bool
+	Extent(const Fixture& fixture, double& lower, double& upper)
+	{
+		if (fixture.kind == FIXTURE::HalfSpace)
+		{
+			// bounded along x0 only if the normal is the x0 axis
+			for (int d = 1; d < Dims; ++d)
+			{
+				if (fixture.normal[d] != 0.0)
+					return false;
+			}
+			if (fixture.normal[0] > 0.0)
+			{
+				lower = fixture.offset / fixture.normal[0];
+				upper = HUGE_VAL;
+			}
+			else if (fixture.normal[0] < 0.0)
+			{
+				lower = -HUGE_VAL;
+				upper = fixture.offset / fixture.normal[0];
+			}
+			else
+				return false;
+
+			return true;
+		}
+
+		lower = fixture.lower[0];
+		upper = fixture.upper[0];
+		return true;
+	}
+
+	static void
+	Build(Set& set, const Fixture* fixtures, int count)
+	{
+		set.count = count;
+		set.unboundedCount = 0;
+
+		// bucket range from the finite bounds
+		double low = HUGE_VAL, high = -HUGE_VAL;
+
+		for (int i = 0; i < count; ++i)
+		{
+			set.fixture[i] = fixtures[i];
+
+			double lower, upper;
+			if (Extent(fixtures[i], lower, upper))
+			{
+				if (std::isfinite(lower))
+				{
+					low = std::fmin(low, lower);
+					high = std::fmax(high, lower);
+				}
+				if (std::isfinite(upper))
+				{
+					low = std::fmin(low, upper);
+					high = std::fmax(high, upper);
+				}
+			}
+		}
+
+		if (high > low)
+		{
+			set.origin = low;
+			set.invWidth = BUCKETS / (high - low);
+		}
+		else
+		{
+			set.origin = std::isfinite(low) ? low : 0.0;
+			set.invWidth = 0.0;
+		}
+
+		// count per bucket, then fill (counting sort)
+		int first[MAX_FIXTURES], last[MAX_FIXTURES];
+		int size[BUCKETS] =
+		{ };
+
+		for (int i = 0; i < count; ++i)
+		{
+			double lower, upper;
+			if (!Extent(set.fixture[i], lower, upper))
+			{
+				set.unbounded[set.unboundedCount++] = static_cast<uint16_t>(i);
+				first[i] = 0;
+				last[i] = -1;
+				continue;
+			}
+
+			first[i] = Bucket(set, lower);
+			last[i] = Bucket(set, upper);
+			for (int b = first[i]; b <= last[i]; ++b)
+				++size[b];
+		}
+
+		set.bucketStart[0] = 0;
+		for (int b = 0; b < BUCKETS; ++b)
+			set.bucketStart[b + 1] = static_cast<uint16_t>(set.bucketStart[b] + size[b]);
+
+		int fill[BUCKETS];
+		for (int b = 0; b < BUCKETS; ++b)
+			fill[b] = set.bucketStart[b];
+
+		for (int i = 0; i < count; ++i)
+		{
+			for (int b = first[i]; b <= last[i]; ++b)
+				set.entry[fill[b]++] = static_cast<uint16_t>(i);
+		}
+	}
+
+	static void
+	Apply(const Fixture& fixture, const double* position, const double* velocity,
+			double* force)
+	{
+		if (fixture.kind == FIXTURE::HalfSpace)
+		{
+			double depth = -fixture.offset;
+			double speed = 0.0;
+
+			for (int d = 0; d < Dims; ++d)
+			{
+				depth += fixture.normal[d] * position[d];
+				speed += fixture.normal[d] * velocity[d];
+			}
+
+			if (depth <= 0.0)
+				return;
+
+			// push back along the normal, damp the inward motion only
+			double push = fixture.stiffness * depth
+					+ ((speed > 0.0) ? fixture.damping * speed : 0.0);
+
+			for (int d = 0; d < Dims; ++d)
+				force[d] -= push * fixture.normal[d];
+
+			return;
+		}
+
+		// box: inside on every coordinate, leave through the nearest face
+		int axis = 0;
+		double depth = HUGE_VAL, direction = 0.0;
+
+		for (int d = 0; d < Dims; ++d)
+		{
+			double below = position[d] - fixture.lower[d];
+			double above = fixture.upper[d] - position[d];
+
+			if (below <= 0.0 || above <= 0.0)
+				return;
+
+			if (below < depth)
+			{
+				axis = d;
+				depth = below;
+				direction = -1.0;
+			}
+			if (above < depth)
+			{
+				axis = d;
+				depth = above;
+				direction = 1.0;
+			}
+		}
+
+		double speed = -direction * velocity[axis];	// > 0 moving deeper
+
+		force[axis] += direction
+				* (fixture.stiffness * depth
+						+ ((speed > 0.0) ? fixture.damping * speed : 0.0));
+	}
+
+	Set _sets[2];
+	std::atomic<Set*> _active;
+	std::atomic<Set*> _acquired;
+	int _tested;
+};
@@ -0,0 +1,119 @@
+/*
+ * mmc_definitions.h
+ *
+ * Created on: Oct 19, 2026
+ * Author: RockyLiu
+ *
+ * Host build only: the subset of the Maestro definitions used by the SIL
+ * programs, with the values of the Elmo headers. Put this directory first
+ * in the include path, the real library is not needed.
+ */
+
+#pragma once
+
+#include <cmath>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <unistd.h>
+
+// the Maestro headers open the std namespace, the SIL programs rely on it.
+using namespace std;
+
+typedef unsigned int MMC_CONNECT_HNDL;
+typedef int (*MMC_MB_CLBK)(unsigned char*, short, void*);
+
+enum OPM402
+{
+	OPM402_NO_MODE = 0,
+	OPM402_PROFILE_POSITION_MODE = 1,
+	OPM402_PROFILE_VELOCITY_MODE = 3,
+	OPM402_PROFILE_TORQUE_MODE = 4,
+	OPM402_HOMING_MODE = 6,
+	OPM402_CYCLIC_SYNC_POSITION_MODE = 8,
+	OPM402_CYCLIC_SYNC_VELOCITY_MODE = 9,
+	OPM402_CYCLIC_SYNC_TORQUE_MODE = 10,
+};
+
+enum MMC_PARAMETER_LIST_ENUM
+{
+	MMC_UCUSER607A_SRC, MMC_UCUSER60FF_SRC, MMC_UCUSER6071_SRC,
+};
+
+enum
+{
+	EMCY_EVT = 1,
+	MOTIONENDED_EVT,
+	HBEAT_EVT,
+	PDORCV_EVT,
+	DRVERROR_EVT,
+	HOME_ENDED_EVT,
+	SYSTEMERROR_EVT,
+	MODBUS_WRITE_EVT,
+};
+
+enum
+{
+	MMCPP_EMCY = 1,
+};
+
+enum MC_DIRECTION_ENUM
+{
+	MC_POSITIVE_DIRECTION = 0, MC_SHORTEST_WAY, MC_NEGATIVE_DIRECTION, MC_CURRENT_DIRECTION,
+};
+
+enum MC_BUFFERED_MODE_ENUM
+{
+	MC_ABORTING_MODE = 0, MC_BUFFERED_MODE,
+};
+
+#define NC_AXIS_DISABLED_MASK			0x00000001
+#define NC_AXIS_STAND_STILL_MASK		0x00000002
+#define NC_AXIS_CONTINUOUS_MOTION_MASK	0x00000010
+#define NC_AXIS_ERROR_STOP_MASK			0x00000100
+
+struct MMC_MOTIONPARAMS_SINGLE
+{
+	float fEndVelocity;
+	double dbDistance;
+	double dbPosition;
+	float fVelocity;
+	float fAcceleration;
+	float fDeceleration;
+	float fJerk;
+	MC_DIRECTION_ENUM eDirection;
+	MC_BUFFERED_MODE_ENUM eBufferMode;
+	unsigned char ucExecute;
+};
+
+struct MMC_MODBUSREADHOLDINGREGISTERSTABLE_OUT
+{
+	short regArr[125];
+};
+
+struct MMC_MODBUSWRITEHOLDINGREGISTERSTABLE_IN
+{
+	int startRef;
+	int refCnt;
+	short regArr[125];
+};
+
+int
+MMC_CreateSYNCTimer(MMC_CONNECT_HNDL hConn, int (*callback)(void), int factor);
+int
+MMC_DestroySYNCTimer(MMC_CONNECT_HNDL hConn);
+int
+MMC_SetRTUserCallback(MMC_CONNECT_HNDL hConn, int priority);
+int
+MMC_CloseConnection(MMC_CONNECT_HNDL hConn);
+
+/*
+ * Sleeps of the SIL programs run on the virtual sync clock once the SYNC
+ * timer is started, so the Modbus loop keeps its period in simulated time.
+ */
+int
+SimUsleep(useconds_t usec);
+
+#define usleep(usec)	SimUsleep(usec)
@@ -0,0 +1,248 @@
+/*
+ * mmcpplib.cpp
+ *
+ * Created on: Oct 19, 2026
+ * Author: RockyLiu
+ *
+ * Host build only: the mock MMC API on top of SimHost::SimMaestro.
+ */
+
+#include "mmcpplib.h"
+#include "sim_maestro.h"
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+using SimHost::SimAxis;
+using SimHost::SimMaestro;
+
+namespace
+{
+	SimAxis&
+	AxisOf(int index)
+	{
+		if (index < 0)
+		{
+			std::cerr << "host simulation: axis used before InitAxisData()\n";
+			abort();
+		}
+		return SimMaestro::Instance().Axis(index);
+	}
+
+	double
+	WallTime(void)
+	{
+		return std::chrono::duration<double>(
+				std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	/*
+	 * Op-mode change / power-on of the drive done once its delay is over.
+	 */
+	void
+	Advance(SimAxis& axis)
+	{
+		const double now = WallTime();
+
+		double due = axis.opModeDue.load(std::memory_order_acquire);
+		if ((due >= 0.0) && (now >= due)
+				&& axis.opModeDue.compare_exchange_strong(due, -1.0))
+			axis.opMode.store(axis.pendingOpMode.load(), std::memory_order_release);
+
+		due = axis.enableDue.load(std::memory_order_acquire);
+		if ((due >= 0.0) && (now >= due)
+				&& axis.enableDue.compare_exchange_strong(due, -1.0))
+			axis.powered.store(true, std::memory_order_release);
+	}
+}
+
+MMC_CONNECT_HNDL CMMCConnection::ConnectIPCEx(int, MMC_MB_CLBK)
+{
+	SimMaestro::Instance();
+	return 1;
+}
+
+void CMMCConnection::RegisterEventCallback(int, void*)
+{
+}
+
+void CMMCHostComm::MbusStartServer(MMC_CONNECT_HNDL, int)
+{
+}
+
+void CMMCHostComm::MbusStopServer(void)
+{
+}
+
+void CMMCHostComm::MbusReadHoldingRegisterTable(int start, int count,
+		MMC_MODBUSREADHOLDINGREGISTERSTABLE_OUT& out)
+{
+	SimMaestro::Instance().ReadRegisters(start, count, out.regArr);
+}
+
+void CMMCHostComm::MbusWriteHoldingRegisterTable(
+		MMC_MODBUSWRITEHOLDINGREGISTERSTABLE_IN& in)
+{
+	SimMaestro::Instance().WriteRegisters(in.startRef, in.refCnt, in.regArr);
+}
+
+CMMCPPGlobal* CMMCPPGlobal::Instance(void)
+{
+	static CMMCPPGlobal instance;
+	return &instance;
+}
+
+void CMMCPPGlobal::SetThrowFlag(bool, bool)
+{
+}
+
+void CMMCPPGlobal::RegisterRTE(
+		int (*)(const char*, unsigned int, unsigned short, short, unsigned short))
+{
+}
+
+void CMMCRTSingleAxis::InitAxisData(const char* name, MMC_CONNECT_HNDL)
+{
+	if (_index < 0)
+		_index = SimMaestro::Instance().AddAxis();
+
+	if (_index < 0)
+	{
+		std::cerr << "host simulation: too many axes, " << name << "\n";
+		abort();
+	}
+}
+
+void CMMCRTSingleAxis::SetDefaultParams(const MMC_MOTIONPARAMS_SINGLE&)
+{
+}
+
+unsigned int CMMCRTSingleAxis::ReadStatus(void)
+{
+	SimAxis& axis = AxisOf(_index);
+
+	Advance(axis);
+
+	if (!axis.powered.load())
+		return NC_AXIS_DISABLED_MASK;
+
+	return (std::fabs(axis.velocity.load()) < axis.drive.standStill) ?
+			NC_AXIS_STAND_STILL_MASK : NC_AXIS_CONTINUOUS_MOTION_MASK;
+}
+
+void CMMCRTSingleAxis::Reset(void)
+{
+}
+
+void CMMCRTSingleAxis::PowerOn(void)
+{
+	SimAxis& axis = AxisOf(_index);
+
+	axis.enableDue.store(WallTime() + axis.drive.enableDelay * 1e-3);
+	Advance(axis);
+}
+
+void CMMCRTSingleAxis::PowerOff(void)
+{
+	SimAxis& axis = AxisOf(_index);
+
+	axis.enableDue.store(-1.0);
+	axis.powered.store(false, std::memory_order_release);
+}
+
+void CMMCRTSingleAxis::SetBoolParameter(long value, MMC_PARAMETER_LIST_ENUM,
+		int)
+{
+	// 0 -> NC profiler, 2 -> user
+	AxisOf(_index).userSource.store(value == 2, std::memory_order_release);
+}
+
+void CMMCRTSingleAxis::SetOpMode(OPM402 mode)
+{
+	SimAxis& axis = AxisOf(_index);
+
+	axis.pendingOpMode.store(mode);
+	axis.opModeDue.store(WallTime() + axis.drive.opModeDelay * 1e-3);
+	Advance(axis);
+}
+
+OPM402 CMMCRTSingleAxis::GetOpMode(void)
+{
+	SimAxis& axis = AxisOf(_index);
+
+	Advance(axis);
+
+	return static_cast<OPM402>(axis.opMode.load(std::memory_order_acquire));
+}
+
+void CMMCRTSingleAxis::SetUser607A(int position)
+{
+	AxisOf(_index).user607A.store(position, std::memory_order_relaxed);
+}
+
+void CMMCRTSingleAxis::SetUser60FF(int velocity)
+{
+	AxisOf(_index).user60FF.store(velocity, std::memory_order_relaxed);
+}
+
+void CMMCRTSingleAxis::SetUser6071(double torque)
+{
+	AxisOf(_index).user6071.store(torque, std::memory_order_relaxed);
+}
+
+int CMMCRTSingleAxis::GetUser607A(void)
+{
+	return AxisOf(_index).user607A.load(std::memory_order_relaxed);
+}
+
+double CMMCRTSingleAxis::GetActualPosition(void)
+{
+	return AxisOf(_index).position.load(std::memory_order_relaxed);
+}
+
+double CMMCRTSingleAxis::GetActualVelocity(void)
+{
+	return AxisOf(_index).velocity.load(std::memory_order_relaxed);
+}
+
+double CMMCRTSingleAxis::GetActualTorque(void)
+{
+	return AxisOf(_index).torque.load(std::memory_order_relaxed);
+}
+
+unsigned long CMMCRTSingleAxis::GetDigInputs(void)
+{
+	return 0;
+}
+
+void CMMCRTSingleAxis::EthercatReadPIVar(unsigned short, unsigned char,
+		short& value)
+{
+	value = AxisOf(_index).analogInput.load(std::memory_order_relaxed);
+}
+
+void CMMCRTSingleAxis::EthercatWritePIVar(unsigned short, int)
+{
+}
+
+int MMC_CreateSYNCTimer(MMC_CONNECT_HNDL, int (*callback)(void), int factor)
+{
+	SimMaestro::Instance().Start(callback, factor);
+	return 0;
+}
+
+int MMC_DestroySYNCTimer(MMC_CONNECT_HNDL)
+{
+	SimMaestro::Instance().Stop();
+	return 0;
+}
+
+int MMC_SetRTUserCallback(MMC_CONNECT_HNDL, int)
+{
+	return 0;
+}
+
+int MMC_CloseConnection(MMC_CONNECT_HNDL)
+{
+	return 0;
+}
@@ -0,0 +1,152 @@
+/*
+ * mmcpplib.h
+ *
+ * Created on: Oct 19, 2026
+ * Author: RockyLiu
+ *
+ * Host build only: mock of the MMC C++ classes used by the SIL programs.
+ * Every CMMCRTSingleAxis is bound at InitAxisData() to a simulated drive
+ * and plant of SimHost::SimMaestro, see sim_maestro.h.
+ */
+
+#pragma once
+
+#include "mmc_definitions.h"
+
+class CMMCException
+{
+public:
+	const char*
+	what(void) const
+	{
+		return "host simulation";
+	}
+
+	const char*
+	axisName(void) const
+	{
+		return "";
+	}
+
+	int
+	error(void) const
+	{
+		return 0;
+	}
+
+	int
+	status(void) const
+	{
+		return 0;
+	}
+};
+
+class CMMCConnection
+{
+public:
+	MMC_CONNECT_HNDL
+	ConnectIPCEx(int eventMask, MMC_MB_CLBK callback);
+
+	void
+	RegisterEventCallback(int event, void* callback);
+};
+
+class CMMCHostComm
+{
+public:
+	void
+	MbusStartServer(MMC_CONNECT_HNDL hConn, int id);
+
+	void
+	MbusStopServer(void);
+
+	void
+	MbusReadHoldingRegisterTable(int start, int count,
+			MMC_MODBUSREADHOLDINGREGISTERSTABLE_OUT& out);
+
+	void
+	MbusWriteHoldingRegisterTable(MMC_MODBUSWRITEHOLDINGREGISTERSTABLE_IN& in);
+};
+
+class CMMCPPGlobal
+{
+public:
+	static CMMCPPGlobal*
+	Instance(void);
+
+	void
+	SetThrowFlag(bool throwOnError, bool throwOnWarning);
+
+	void
+	RegisterRTE(int (*callback)(const char*, unsigned int, unsigned short, short,
+			unsigned short));
+};
+
+class CMMCRTSingleAxis
+{
+public:
+	CMMCRTSingleAxis() :
+			_index(-1)
+	{
+	}
+
+	void
+	InitAxisData(const char* name, MMC_CONNECT_HNDL hConn);
+
+	void
+	SetDefaultParams(const MMC_MOTIONPARAMS_SINGLE& params);
+
+	unsigned int
+	ReadStatus(void);
+
+	void
+	Reset(void);
+
+	void
+	PowerOn(void);
+
+	void
+	PowerOff(void);
+
+	void
+	SetBoolParameter(long value, MMC_PARAMETER_LIST_ENUM param, int index);
+
+	void
+	SetOpMode(OPM402 mode);
+
+	OPM402
+	GetOpMode(void);
+
+	void
+	SetUser607A(int position);
+
+	void
+	SetUser60FF(int velocity);
+
+	void
+	SetUser6071(double torque);
+
+	int
+	GetUser607A(void);
+
+	double
+	GetActualPosition(void);
+
+	double
+	GetActualVelocity(void);
+
+	double
+	GetActualTorque(void);
+
+	unsigned long
+	GetDigInputs(void);
+
+	void
+	EthercatReadPIVar(unsigned short offset, unsigned char size, short& value);
+
+	void
+	EthercatWritePIVar(unsigned short offset, int value);
+
+private:
+	int _index;		// simulated axis, -1 before InitAxisData()
+};
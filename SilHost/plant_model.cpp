@@ -0,0 +1,104 @@
+/*
+ * plant_model.cpp
+ *
+ * Created on: Oct 19, 2026
+ * Author: RockyLiu
+ */
+
+#include "plant_model.h"
+#include <cmath>
+
+namespace SimHost
+{
+	namespace
+	{
+		constexpr double TWO_PI = 6.2831853071795862;
+		constexpr double STICK_SPEED = 1e-6;	// rad/s, below -> stiction applies
+	}
+
+	PlantModel::PlantModel(const PlantParams& params)
+	{
+		Configure(params);
+	}
+
+	void PlantModel::Configure(const PlantParams& params)
+	{
+		_params = params;
+		if (_params.substeps < 1)
+			_params.substeps = 1;
+
+		_rigid = (params.loadInertia <= 0.0) || (params.stiffness <= 0.0);
+		if (_rigid)
+			_params.substeps = 1;	// no resonance to resolve
+		_countsPerRad = params.countsPerRev / TWO_PI;
+
+		Reset();
+	}
+
+	void PlantModel::Reset(double counts)
+	{
+		_motorAngle = _loadAngle = counts / _countsPerRad;
+		_motorSpeed = _loadSpeed = 0.0;
+	}
+
+	double PlantModel::Friction(double speed, double& drive) const
+	{
+		// moving: Coulomb + viscous against the motion
+		if (std::fabs(speed) > STICK_SPEED)
+			return -std::copysign(_params.coulomb, speed) - _params.viscous * speed;
+
+		// at rest: stiction holds as long as the driving torque is below Coulomb
+		if (std::fabs(drive) <= _params.coulomb)
+		{
+			drive = 0.0;
+			return 0.0;
+		}
+
+		return -std::copysign(_params.coulomb, drive);
+	}
+
+	void PlantModel::Step(double torque, double ts)
+	{
+		const double h = ts / _params.substeps;
+		const double motorTorque = _params.torqueConstant * torque;
+
+		for (int i = 0; i < _params.substeps; ++i)
+		{
+			double coupling = 0.0;
+			double inertia = _params.motorInertia;
+			double gravity = -_params.unbalance
+					* std::sin(_rigid ? _motorAngle : _loadAngle);
+
+			if (_rigid)
+			{
+				inertia += _params.loadInertia;
+				coupling = -gravity;
+			}
+			else
+				coupling = _params.stiffness * (_motorAngle - _loadAngle)
+						+ _params.damping * (_motorSpeed - _loadSpeed);
+
+			double drive = motorTorque - coupling;
+			double friction = Friction(_motorSpeed, drive);
+			double speed = _motorSpeed + (drive + friction) * h / inertia;
+
+			// friction alone does not reverse the motion, it stops it
+			if ((speed * _motorSpeed < 0.0) && (std::fabs(drive) <= _params.coulomb))
+				speed = 0.0;
+
+			_motorSpeed = speed;
+			_motorAngle += _motorSpeed * h;
+
+			if (!_rigid)
+			{
+				_loadSpeed += (coupling + gravity) * h / _params.loadInertia;
+				_loadAngle += _loadSpeed * h;
+			}
+		}
+	}
+
+	double PlantModel::GetCounts(void) const
+	{
+		return std::floor(_motorAngle * _countsPerRad);
+	}
+}
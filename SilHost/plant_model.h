@@ -0,0 +1,105 @@
+/*
+ * plant_model.h
+ *
+ * Created on: Oct 19, 2026
+ * Author: RockyLiu
+ *
+ * Motor + load plant of one simulated axis.
+ *
+ * Two inertias coupled by a spring / damper (one resonance), viscous and
+ * Coulomb friction with stiction on the motor side, gravity of an
+ * unbalanced load (0 at position 0) on the load side, integrated with
+ * semi-implicit Euler in 'substeps' steps per sync cycle. A load inertia or
+ * stiffness of 0 gives a rigid single inertia. The encoder is on the motor
+ * side and quantized to whole counts.
+ */
+
+#pragma once
+
+namespace SimHost
+{
+	struct PlantParams
+	{
+		double motorInertia = 2.0e-5;	// kg.m2
+		double loadInertia = 0.0;		// kg.m2, 0 -> rigid
+		double stiffness = 0.0;			// Nm/rad of the coupling, 0 -> rigid
+		double damping = 0.0;			// Nm.s/rad of the coupling
+		double viscous = 1.0e-5;		// Nm.s/rad
+		double coulomb = 0.002;			// Nm
+		double unbalance = 0.0;			// Nm, gravity torque of the load at 90 deg
+		double torqueConstant = 0.1;	// Nm per torque command unit
+		double countsPerRev = 10000.0;	// encoder resolution
+		int substeps = 8;				// integration steps per sync cycle, 1 when rigid
+	};
+
+	class PlantModel
+	{
+	public:
+		explicit
+		PlantModel(const PlantParams& params = PlantParams());
+
+		void
+		Configure(const PlantParams& params);
+
+		/*
+		 * Back to rest at 'counts'.
+		 */
+		void
+		Reset(double counts = 0.0);
+
+		/*
+		 * Apply 'torque' (command unit) during 'ts' seconds.
+		 */
+		void
+		Step(double torque, double ts);
+
+		/*
+		 * Encoder position, whole counts.
+		 */
+		double
+		GetCounts(void) const;
+
+		/*
+		 * Exact motor / load speed, counts/s.
+		 */
+		double
+		GetMotorSpeed(void) const
+		{
+			return _motorSpeed * _countsPerRad;
+		}
+
+		double
+		GetLoadSpeed(void) const
+		{
+			return (_rigid ? _motorSpeed : _loadSpeed) * _countsPerRad;
+		}
+
+		/*
+		 * Exact load position, counts.
+		 */
+		double
+		GetLoadPosition(void) const
+		{
+			return (_rigid ? _motorAngle : _loadAngle) * _countsPerRad;
+		}
+
+		const PlantParams&
+		GetParams(void) const
+		{
+			return _params;
+		}
+
+	private:
+		double
+		Friction(double speed, double& drive) const;
+
+		PlantParams _params;
+		bool _rigid;
+		double _countsPerRad;
+
+		double _motorAngle;		// rad
+		double _motorSpeed;		// rad/s
+		double _loadAngle;
+		double _loadSpeed;
+	};
+}
@@ -0,0 +1,451 @@
+/*
+ * sim_maestro.cpp
+ *
+ * Created on: Oct 19, 2026
+ * Author: RockyLiu
+ */
+
+#include "sim_maestro.h"
+#include <chrono>
+#include <climits>
+#include <cstring>
+#include <iostream>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+
+namespace SimHost
+{
+	namespace
+	{
+		double
+		Clamp(double value, double limit)
+		{
+			return (value > limit) ? limit : (value < -limit) ? -limit : value;
+		}
+
+		int64_t
+		NowNs(void)
+		{
+			struct timespec ts;
+			clock_gettime(CLOCK_MONOTONIC, &ts);
+			return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+		}
+
+		double
+		EnvDouble(const char* name, double fallback)
+		{
+			const char* value = getenv(name);
+			return value ? atof(value) : fallback;
+		}
+
+		/*
+		 * "key=value,..." into the plant and drive parameters, unknown keys reported.
+		 */
+		void
+		ParsePlant(const char* text, PlantParams& plant, DriveParams& drive)
+		{
+			struct Key
+			{
+				const char* name;
+				double* value;
+			} keys[] =
+			{
+			{ "motorInertia", &plant.motorInertia },
+			{ "loadInertia", &plant.loadInertia },
+			{ "stiffness", &plant.stiffness },
+			{ "damping", &plant.damping },
+			{ "viscous", &plant.viscous },
+			{ "coulomb", &plant.coulomb },
+			{ "unbalance", &plant.unbalance },
+			{ "torqueConstant", &plant.torqueConstant },
+			{ "countsPerRev", &plant.countsPerRev },
+			{ "positionKp", &drive.positionKp },
+			{ "velocityKp", &drive.velocityKp },
+			{ "velocityKi", &drive.velocityKi },
+			{ "torqueLimit", &drive.torqueLimit },
+			{ "standStill", &drive.standStill },
+			{ "opModeDelay", &drive.opModeDelay },
+			{ "enableDelay", &drive.enableDelay } };
+
+			char name[64];
+			double value;
+			int length;
+
+			while (sscanf(text, " %63[^=]=%lf%n", name, &value, &length) == 2)
+			{
+				bool found = false;
+				for (const Key& key : keys)
+				{
+					if (strcmp(key.name, name) == 0)
+					{
+						*key.value = value;
+						found = true;
+					}
+				}
+				if (strcmp(name, "substeps") == 0)
+				{
+					plant.substeps = static_cast<int>(value);
+					found = true;
+				}
+				if (!found)
+					std::cerr << "SIL_HOST_PLANT: unknown key " << name << "\n";
+
+				text += length;
+				if (*text != ',')
+					break;
+				++text;
+			}
+		}
+	}
+
+	void SimAxis::Step(double ts)
+	{
+		bool user = userSource.load(std::memory_order_acquire);
+		double command = 0.0;
+
+		if (!powered.load(std::memory_order_acquire))
+		{
+			integral = 0.0;
+			holdPosition = counts;
+		}
+		else
+		{
+			if (!user && lastUserSource)
+				holdPosition = counts;
+
+			double velocityRef = 0.0;
+			bool velocityLoop = true;
+
+			switch (opMode.load(std::memory_order_acquire))
+			{
+			case OPM402_CYCLIC_SYNC_POSITION_MODE:
+				velocityRef = drive.positionKp
+						* ((user ? user607A.load(std::memory_order_relaxed) : holdPosition)
+								- counts);
+				break;
+			case OPM402_CYCLIC_SYNC_VELOCITY_MODE:
+				velocityRef = user ? user60FF.load(std::memory_order_relaxed) : 0.0;
+				break;
+			case OPM402_CYCLIC_SYNC_TORQUE_MODE:
+				command = user ? user6071.load(std::memory_order_relaxed) : 0.0;
+				velocityLoop = false;
+				break;
+			default:
+				velocityLoop = false;
+				break;
+			}
+
+			if (velocityLoop)
+			{
+				double error = velocityRef - velocity.load(std::memory_order_relaxed);
+				integral = Clamp(integral + drive.velocityKi * error * ts, drive.torqueLimit);
+				command = drive.velocityKp * error + integral;
+			}
+			else
+				integral = 0.0;
+
+			command = Clamp(command, drive.torqueLimit);
+		}
+		lastUserSource = user;
+
+		plant.Step(command, ts);
+
+		double next = plant.GetCounts();
+		velocity.store((next - counts) / ts, std::memory_order_relaxed);
+		position.store(next, std::memory_order_relaxed);
+		torque.store(command, std::memory_order_relaxed);
+		counts = next;
+	}
+
+	SimMaestro& SimMaestro::Instance(void)
+	{
+		static SimMaestro instance;
+		return instance;
+	}
+
+	SimMaestro::SimMaestro() :
+			_ts(0.00025), _speed(0.0), _duration(0.0), _axisCount(0), _scriptCount(
+					0), _scriptNext(0), _trace(nullptr), _decimate(1), _callback(
+					nullptr), _running(false), _cycle(0), _wakeCycle(ULLONG_MAX), _wallTime(
+					0.0), _callbackMin(0), _callbackMax(0), _callbackSum(0.0)
+	{
+		memset(_registers, 0, sizeof(_registers));
+		Configure();
+	}
+
+	SimMaestro::~SimMaestro()
+	{
+		Stop();
+		if (_trace)
+			fclose(_trace);
+	}
+
+	void SimMaestro::Configure(void)
+	{
+		_ts = EnvDouble("SIL_HOST_CYCLE_US", 250.0) * 1e-6;
+		_speed = EnvDouble("SIL_HOST_SPEED", 0.0);
+		_duration = EnvDouble("SIL_HOST_DURATION", 0.0);
+		_decimate = static_cast<int>(EnvDouble("SIL_HOST_DECIMATE", 1.0));
+		if (_decimate < 1)
+			_decimate = 1;
+
+		PlantParams plant;
+		DriveParams drive;
+		if (const char* text = getenv("SIL_HOST_PLANT"))
+			ParsePlant(text, plant, drive);
+
+		for (SimAxis& axis : _axes)
+		{
+			axis.plant.Configure(plant);
+			axis.drive = drive;
+		}
+
+		if (const char* text = getenv("SIL_HOST_SCRIPT"))
+		{
+			double time;
+			char target[8];
+			int index, value, length;
+
+			while (_scriptCount < MAX_SCRIPT
+					&& sscanf(text, " %lf:%7[a-z]%d=%d%n", &time, target, &index, &value,
+							&length) == 4)
+			{
+				ScriptEntry& entry = _script[_scriptCount];
+				entry.time = time;
+				entry.analog = (strcmp(target, "ai") == 0);
+				entry.index = index;
+				entry.value = static_cast<short>(value);
+
+				if ((entry.analog && index >= 0 && index < MAX_AXES)
+						|| (!entry.analog && strcmp(target, "r") == 0 && index >= 0
+								&& index < MAX_REGISTERS))
+					++_scriptCount;
+				else
+					std::cerr << "SIL_HOST_SCRIPT: bad target " << target << index << "\n";
+
+				text += length;
+				if (*text != ';')
+					break;
+				++text;
+			}
+
+			// applied in time order
+			for (int i = 1; i < _scriptCount; ++i)
+			{
+				for (int j = i; j > 0 && _script[j].time < _script[j - 1].time; --j)
+				{
+					ScriptEntry entry = _script[j];
+					_script[j] = _script[j - 1];
+					_script[j - 1] = entry;
+				}
+			}
+		}
+
+		if (const char* name = getenv("SIL_HOST_TRACE"))
+		{
+			_trace = fopen(name, "w");
+			if (!_trace)
+				std::cerr << "SIL_HOST_TRACE: can not open " << name << "\n";
+		}
+	}
+
+	int SimMaestro::AddAxis(void)
+	{
+		return (_axisCount < MAX_AXES) ? _axisCount++ : -1;
+	}
+
+	void SimMaestro::Start(int (*callback)(void), int factor)
+	{
+		Stop();
+
+		if (factor < 1)
+			factor = 1;
+
+		_callback = callback;
+		_ts = EnvDouble("SIL_HOST_CYCLE_US", 250.0) * 1e-6 * factor;
+		_running.store(true, std::memory_order_release);
+		_thread = std::thread(&SimMaestro::Run, this);
+	}
+
+	void SimMaestro::Stop(void)
+	{
+		if (!_running.exchange(false))
+			return;
+
+		_thread.join();
+		{
+			std::lock_guard<std::mutex> lock(_sleepMutex);
+		}
+		_sleepCondition.notify_all();
+
+		Report();
+	}
+
+	void SimMaestro::Run(void)
+	{
+		const int64_t period = (_speed > 0.0) ? static_cast<int64_t>(_ts * 1e9 / _speed) : 0;
+		const int64_t start = NowNs();
+		int64_t next = start;
+		bool terminated = false;
+
+		// free running never blocks, it must not starve the other threads of
+		// the RT CPUs when it inherited SCHED_FIFO from the RT profile.
+		if (!period)
+		{
+			struct sched_param param;
+			param.sched_priority = 0;
+			pthread_setschedparam(pthread_self(), SCHED_OTHER, &param);
+		}
+
+		_callbackMin = LLONG_MAX;
+		_callbackMax = 0;
+		_callbackSum = 0.0;
+
+		while (_running.load(std::memory_order_acquire))
+		{
+			uint64_t cycle = _cycle.load(std::memory_order_relaxed);
+			double time = cycle * _ts;
+
+			for (int i = 0; i < _axisCount; ++i)
+				_axes[i].Step(_ts);
+
+			while (_scriptNext < _scriptCount && _script[_scriptNext].time <= time)
+			{
+				const ScriptEntry& entry = _script[_scriptNext++];
+				if (entry.analog)
+					_axes[entry.index].analogInput.store(entry.value, std::memory_order_relaxed);
+				else
+					WriteRegisters(entry.index, 1, &entry.value);
+			}
+
+			if (!terminated && _duration > 0.0 && time >= _duration)
+			{
+				short terminate = 1;
+				WriteRegisters(0, 1, &terminate);
+				terminated = true;
+			}
+
+			int64_t begin = NowNs();
+			_callback();
+			int64_t cost = NowNs() - begin;
+
+			_callbackMin = (cost < _callbackMin) ? cost : _callbackMin;
+			_callbackMax = (cost > _callbackMax) ? cost : _callbackMax;
+			_callbackSum += cost;
+
+			if (_trace && (cycle % _decimate) == 0)
+				Trace();
+
+			_cycle.store(cycle + 1, std::memory_order_release);
+
+			if (cycle + 1 >= _wakeCycle.load(std::memory_order_acquire))
+			{
+				_wakeCycle.store(ULLONG_MAX, std::memory_order_relaxed);
+				{
+					std::lock_guard<std::mutex> lock(_sleepMutex);
+				}
+				_sleepCondition.notify_all();
+			}
+
+			if (period)
+			{
+				next += period;
+				struct timespec ts;
+				ts.tv_sec = next / 1000000000;
+				ts.tv_nsec = next % 1000000000;
+				clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+			}
+		}
+
+		_wallTime = (NowNs() - start) * 1e-9;
+	}
+
+	void SimMaestro::Trace(void)
+	{
+		fprintf(_trace, "%.6f", GetCycle() * _ts);
+
+		for (int i = 0; i < _axisCount; ++i)
+		{
+			const SimAxis& axis = _axes[i];
+			double command =
+					(axis.opMode == OPM402_CYCLIC_SYNC_POSITION_MODE) ? axis.user607A.load() :
+					(axis.opMode == OPM402_CYCLIC_SYNC_VELOCITY_MODE) ? axis.user60FF.load() :
+							axis.user6071.load();
+
+			fprintf(_trace, " %g %.0f %g %g", command, axis.position.load(),
+					axis.velocity.load(), axis.torque.load());
+		}
+		fputc('\n', _trace);
+	}
+
+	void SimMaestro::Sleep(double seconds)
+	{
+		if (!IsRunning())
+			return;
+
+		const uint64_t target = GetCycle()
+				+ static_cast<uint64_t>(std::ceil(seconds / _ts));
+
+		std::unique_lock<std::mutex> lock(_sleepMutex);
+
+		while (IsRunning() && GetCycle() < target)
+		{
+			// register the earliest wake-up, the clock thread notifies when it is reached
+			uint64_t wake = _wakeCycle.load(std::memory_order_acquire);
+			while (target < wake
+					&& !_wakeCycle.compare_exchange_weak(wake, target,
+							std::memory_order_acq_rel))
+				;
+
+			_sleepCondition.wait_for(lock, std::chrono::milliseconds(100));
+		}
+	}
+
+	void SimMaestro::ReadRegisters(int start, int count, short* out)
+	{
+		std::lock_guard<std::mutex> lock(_registerMutex);
+
+		for (int i = 0; i < count; ++i)
+			out[i] = (start + i < MAX_REGISTERS) ? _registers[start + i] : 0;
+	}
+
+	void SimMaestro::WriteRegisters(int start, int count, const short* in)
+	{
+		std::lock_guard<std::mutex> lock(_registerMutex);
+
+		for (int i = 0; i < count && start + i < MAX_REGISTERS; ++i)
+			_registers[start + i] = in[i];
+	}
+
+	void SimMaestro::Report(void) const
+	{
+		uint64_t cycles = GetCycle();
+		double simulated = cycles * _ts;
+
+		std::cout << "host simulation: " << cycles << " cycles, " << simulated
+				<< " s simulated in " << _wallTime << " s";
+		if (_wallTime > 0.0)
+			std::cout << " (x" << simulated / _wallTime << " real time)";
+		if (cycles)
+			std::cout << ", callback min " << _callbackMin / 1000.0 << " us, avg "
+					<< _callbackSum / cycles / 1000.0 << " us, max "
+					<< _callbackMax / 1000.0 << " us";
+		std::cout << "\n";
+	}
+}
+
+/*
+ * usleep() of the program, see mmc_definitions.h.
+ */
+int SimUsleep(useconds_t usec)
+{
+	SimHost::SimMaestro& maestro = SimHost::SimMaestro::Instance();
+
+	if (maestro.IsRunning())
+		maestro.Sleep(usec * 1e-6);
+	else
+		std::this_thread::sleep_for(std::chrono::microseconds(usec));
+
+	return 0;
+}
@@ -0,0 +1,242 @@
+/*
+ * sim_maestro.h
+ *
+ * Created on: Oct 19, 2026
+ * Author: RockyLiu
+ *
+ * Host-side Maestro simulator: the SIL programs are built unchanged against
+ * the mock headers of this directory and run on a Linux PC, with simulated
+ * drives / plants and a virtual sync clock, as fast as the CPU allows.
+ *
+ * Virtual sync clock: MMC_CreateSYNCTimer() starts a thread which, every
+ * cycle, steps the drive and plant of all axes by one sync period, applies
+ * the script and calls the user callback. The simulated time only depends
+ * on the number of cycles; 'speed' paces it (1 -> real time), 0 runs free.
+ * usleep() of the program waits for the simulated time (see SimUsleep()),
+ * or the wall time before the clock is started.
+ *
+ * Drives: CSP / CSV are closed by a P position loop and a PI velocity loop
+ * inside the simulated drive, CST applies the user torque. Velocity feedback
+ * is the encoder difference over one sync period, like the real drive.
+ *
+ * Configuration, environment variables, all optional:
+ * 	SIL_HOST_PLANT		"key=value,..." PlantParams / DriveParams, e.g.
+ * 						"motorInertia=2e-5,loadInertia=1e-5,stiffness=20,coulomb=0.004"
+ * 	SIL_HOST_CYCLE_US	sync period, default 250
+ * 	SIL_HOST_SPEED		1 -> real time, 0 (default) -> as fast as possible
+ * 	SIL_HOST_DURATION	s of simulated time, then Modbus register 0 is set (terminate)
+ * 	SIL_HOST_SCRIPT		"time:target=value;..." target r<n> -> Modbus register n,
+ * 						ai<n> -> analog input of axis n, e.g. "0.5:r6=4;1:r1=2000"
+ * 	SIL_HOST_TRACE		file, one line per traced cycle: time, and per axis
+ * 						command, position, velocity, torque
+ * 	SIL_HOST_DECIMATE	trace every n-th cycle, default 1
+ *
+ * Build commands in Readme.md, this directory must come first in the include path.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include "mmc_definitions.h"
+#include "plant_model.h"
+
+namespace SimHost
+{
+	struct DriveParams
+	{
+		double positionKp = 100.0;		// 1/s, CSP
+		double velocityKp = 1.0e-4;		// torque unit per count/s, CSP / CSV
+		double velocityKi = 0.016;		// torque unit per count
+		double torqueLimit = 5.0;		// torque unit
+		double standStill = 50.0;		// counts/s, below -> stand still status
+		double opModeDelay = 0.0;		// ms wall time, SetOpMode() -> reported
+		double enableDelay = 0.0;		// ms wall time, PowerOn() -> enabled
+	};
+
+	/**
+	 * Simulated drive + plant of one axis. The command / feedback words are
+	 * atomics, they are written by the program (SYNC callback or not) and by
+	 * the clock thread.
+	 */
+	struct SimAxis
+	{
+		PlantModel plant;
+		DriveParams drive;
+
+		std::atomic<int> opMode
+		{ OPM402_NO_MODE };
+		std::atomic<bool> powered
+		{ false };
+		std::atomic<bool> userSource
+		{ false };
+
+		std::atomic<int> user607A
+		{ 0 };
+		std::atomic<int> user60FF
+		{ 0 };
+		std::atomic<double> user6071
+		{ 0.0 };
+		std::atomic<short> analogInput
+		{ 0 };
+
+		std::atomic<double> position
+		{ 0.0 };	// counts
+		std::atomic<double> velocity
+		{ 0.0 };	// counts/s
+		std::atomic<double> torque
+		{ 0.0 };	// torque unit, applied in the last cycle
+
+		// op-mode change / power-on in progress, s wall time, < 0 -> none
+		std::atomic<int> pendingOpMode
+		{ OPM402_NO_MODE };
+		std::atomic<double> opModeDue
+		{ -1.0 };
+		std::atomic<double> enableDue
+		{ -1.0 };
+
+		// clock thread only
+		double counts = 0.0;
+		double holdPosition = 0.0;	// CSP target while the source is not the user
+		double integral = 0.0;
+		bool lastUserSource = false;
+
+		/*
+		 * Clock thread: one sync period of drive + plant.
+		 */
+		void
+		Step(double ts);
+	};
+
+	class SimMaestro
+	{
+	public:
+		static constexpr int MAX_AXES = 16;
+		static constexpr int MAX_REGISTERS = 125;
+		static constexpr int MAX_SCRIPT = 64;
+
+		static SimMaestro&
+		Instance(void);
+
+		SimMaestro(const SimMaestro&) = delete;
+		SimMaestro&
+		operator=(const SimMaestro&) = delete;
+
+		/*
+		 * Next free simulated axis, -1 when all are in use.
+		 */
+		int
+		AddAxis(void);
+
+		SimAxis&
+		Axis(int index)
+		{
+			return _axes[index];
+		}
+
+		/*
+		 * Virtual sync clock.
+		 */
+		void
+		Start(int (*callback)(void), int factor);
+
+		void
+		Stop(void);
+
+		bool
+		IsRunning(void) const
+		{
+			return _running.load(std::memory_order_acquire);
+		}
+
+		uint64_t
+		GetCycle(void) const
+		{
+			return _cycle.load(std::memory_order_acquire);
+		}
+
+		double
+		GetTime(void) const
+		{
+			return GetCycle() * _ts;
+		}
+
+		/*
+		 * Block the caller for 'seconds' of simulated time.
+		 */
+		void
+		Sleep(double seconds);
+
+		/*
+		 * Modbus holding registers.
+		 */
+		void
+		ReadRegisters(int start, int count, short* out);
+
+		void
+		WriteRegisters(int start, int count, const short* in);
+
+		/*
+		 * Cycles, simulated / wall time and callback cost, to stdout.
+		 */
+		void
+		Report(void) const;
+
+	private:
+		struct ScriptEntry
+		{
+			double time;
+			bool analog;	// false -> Modbus register
+			int index;
+			short value;
+		};
+
+		SimMaestro();
+		~SimMaestro();
+
+		void
+		Configure(void);
+
+		void
+		Run(void);
+
+		void
+		Trace(void);
+
+		double _ts;
+		double _speed;
+		double _duration;
+
+		SimAxis _axes[MAX_AXES];
+		int _axisCount;
+
+		std::mutex _registerMutex;
+		short _registers[MAX_REGISTERS];
+
+		ScriptEntry _script[MAX_SCRIPT];
+		int _scriptCount;
+		int _scriptNext;
+
+		FILE* _trace;
+		int _decimate;
+
+		int (*_callback)(void);
+		std::thread _thread;
+		std::atomic<bool> _running;
+		std::atomic<uint64_t> _cycle;
+
+		std::mutex _sleepMutex;
+		std::condition_variable _sleepCondition;
+		std::atomic<uint64_t> _wakeCycle;	// earliest cycle a sleeper waits for
+
+		// statistics, clock thread only while running
+		double _wallTime;
+		int64_t _callbackMin;
+		int64_t _callbackMax;
+		double _callbackSum;
+	};
+}